@@ -0,0 +1,303 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "bounds.h"
+#include "bvh.h"
+
+namespace uv
+{
+	// Dynamic bounding volume tree over moving boxes, for broad phase collision detection. Every box is stored
+	// enlarged by a margin, its fat bounds, and reinserted only when it leaves them, so most moves cost nothing.
+	// Nodes live in one pool and are recycled through a free list. Insertion descends along the smallest growth
+	// in surface area, and the nodes above every change are rebalanced by rotations, keeping the tree shallow.
+	// Each box is identified by the proxy returned by insert(), which stays valid until it is removed.
+	template <class T>
+	class AabbTree
+	{
+	public:
+		using U = type::identity<T>;
+		using M = type::mul<T>;
+
+		static constexpr uint32_t null = std::numeric_limits<uint32_t>::max();
+		static constexpr size_t max_depth = 64;
+
+	private:
+		struct Node
+		{
+			Bounds3<T> box;
+			uint32_t parent; // the next free node while in the free list
+			uint32_t child[2]; // null for leaves
+			int32_t height; // zero for leaves, -1 in the free list
+			bool moved; // inserted or reinserted since the last pairs()
+
+			bool leaf() const { return child[0] == null; }
+		};
+
+		T _margin;
+		std::vector<Node> _nodes;
+		uint32_t _root = null;
+		uint32_t _free = null;
+		size_t _proxies = 0;
+		std::vector<uint32_t> _moved;
+
+		uint32_t _allocate()
+		{
+			if (_free == null)
+			{
+				_nodes.push_back(Node());
+				_free = uint32_t(_nodes.size() - 1);
+				_nodes[_free].parent = null;
+			}
+			const uint32_t i = _free;
+			_free = _nodes[i].parent;
+			_nodes[i].parent = _nodes[i].child[0] = _nodes[i].child[1] = null;
+			_nodes[i].height = 0;
+			_nodes[i].moved = false;
+			return i;
+		}
+		void _release(uint32_t i)
+		{
+			_nodes[i].parent = _free;
+			_nodes[i].height = -1;
+			_free = i;
+		}
+
+		// The box grown by the margin on every side, and further along the displacement expected before the next move
+		Bounds3<T> _fatten(const Bounds3<T>& box, const Vec3<T>& displacement, U scale) const
+		{
+			Bounds3<T> fat = box;
+			for (size_t k = 0; k < 3; ++k)
+			{
+				const T d = displacement[k] * scale;
+				fat[k].min = fat[k].min - _margin * scale + (d < T(0) ? d : T(0));
+				fat[k].max = fat[k].max + _margin * scale + (d < T(0) ? T(0) : d);
+			}
+			return fat;
+		}
+		static bool _contains(const Bounds3<T>& outer, const Bounds3<T>& inner) { return all(min(outer) <= min(inner)) && all(max(inner) <= max(outer)); }
+
+		void _replace_child(uint32_t parent, uint32_t from, uint32_t to)
+		{
+			if (parent == null)
+				_root = to;
+			else
+				_nodes[parent].child[_nodes[parent].child[1] == from] = to;
+		}
+		void _refit(uint32_t i)
+		{
+			Node& node = _nodes[i];
+			const Node& a = _nodes[node.child[0]];
+			const Node& b = _nodes[node.child[1]];
+			node.box = bounds(a.box, b.box);
+			node.height = 1 + std::max(a.height, b.height);
+		}
+
+		// Lifts the taller child of node a when the heights of its children differ by more than one, returning the
+		// node now in its place. The taller grandchild stays under the lifted child and the shorter one moves to a.
+		uint32_t _balance(uint32_t a)
+		{
+			const Node& node = _nodes[a];
+			if (node.leaf() || node.height < 2)
+				return a;
+			const int32_t balance = _nodes[node.child[1]].height - _nodes[node.child[0]].height;
+			if (balance >= -1 && balance <= 1)
+				return a;
+			const size_t s = balance > 1;
+			const uint32_t c = node.child[s];
+			const uint32_t f = _nodes[c].child[0], g = _nodes[c].child[1];
+			const uint32_t keep = _nodes[f].height > _nodes[g].height ? f : g, move = keep == f ? g : f;
+
+			_nodes[c].parent = _nodes[a].parent;
+			_replace_child(_nodes[c].parent, a, c);
+			_nodes[c].child[0] = a;
+			_nodes[c].child[1] = keep;
+			_nodes[a].parent = c;
+			_nodes[a].child[s] = move;
+			_nodes[move].parent = a;
+			_refit(a);
+			_refit(c);
+			return c;
+		}
+
+		// Refits and rebalances the nodes from i up to the root
+		void _ascend(uint32_t i)
+		{
+			while (i != null)
+			{
+				i = _balance(i);
+				_refit(i);
+				i = _nodes[i].parent;
+			}
+		}
+
+		void _insert_leaf(uint32_t leaf)
+		{
+			if (_root == null)
+			{
+				_root = leaf;
+				_nodes[leaf].parent = null;
+				return;
+			}
+			// the cost of making a node the sibling of the leaf is the area of their union, plus the growth of every
+			// ancestor, so descend while a child is cheaper than stopping here
+			const Bounds3<T> box = _nodes[leaf].box;
+			uint32_t i = _root;
+			while (!_nodes[i].leaf())
+			{
+				const Node& node = _nodes[i];
+				const M area = details::half_area(node.box);
+				const M combined = details::half_area(bounds(node.box, box));
+				const M cost = combined + combined;
+				const M inherited = (combined - area) + (combined - area);
+				M child_cost[2];
+				for (size_t s = 0; s < 2; ++s)
+				{
+					const Node& child = _nodes[node.child[s]];
+					const M grown = details::half_area(bounds(child.box, box));
+					child_cost[s] = (child.leaf() ? grown : grown - details::half_area(child.box)) + inherited;
+				}
+				if (cost < child_cost[0] && cost < child_cost[1])
+					break;
+				i = node.child[child_cost[1] < child_cost[0]];
+			}
+
+			const uint32_t sibling = i;
+			const uint32_t parent = _allocate();
+			const uint32_t grand = _nodes[sibling].parent;
+			_nodes[parent].parent = grand;
+			_nodes[parent].box = bounds(_nodes[sibling].box, box);
+			_nodes[parent].height = _nodes[sibling].height + 1;
+			_nodes[parent].child[0] = sibling;
+			_nodes[parent].child[1] = leaf;
+			_replace_child(grand, sibling, parent);
+			_nodes[sibling].parent = parent;
+			_nodes[leaf].parent = parent;
+			_ascend(grand);
+		}
+
+		void _remove_leaf(uint32_t leaf)
+		{
+			if (leaf == _root)
+			{
+				_root = null;
+				return;
+			}
+			const uint32_t parent = _nodes[leaf].parent;
+			const uint32_t grand = _nodes[parent].parent;
+			const uint32_t sibling = _nodes[parent].child[_nodes[parent].child[0] == leaf];
+			_replace_child(grand, parent, sibling);
+			_nodes[sibling].parent = grand;
+			_release(parent);
+			_ascend(grand);
+		}
+
+		void _mark(uint32_t proxy)
+		{
+			if (!_nodes[proxy].moved)
+			{
+				_nodes[proxy].moved = true;
+				_moved.push_back(proxy);
+			}
+		}
+
+	public:
+		explicit AabbTree(T margin) : _margin(margin) { Expects(!(margin < T(0))); }
+
+		T margin() const { return _margin; }
+		// The number of boxes in the tree
+		size_t size() const { return _proxies; }
+		// The length of the longest path from the root to a leaf, zero for a single box, -1 when empty
+		int32_t height() const { return _root == null ? -1 : _nodes[_root].height; }
+		// The enlarged box stored for a proxy, which contains the box last given for it
+		const Bounds3<T>& fat(uint32_t proxy) const { return _nodes[proxy].box; }
+
+		uint32_t insert(const Bounds3<T>& box)
+		{
+			const uint32_t proxy = _allocate();
+			_nodes[proxy].box = _fatten(box, Vec3<T>(T(0)), U(1));
+			_insert_leaf(proxy);
+			_mark(proxy);
+			++_proxies;
+			return proxy;
+		}
+
+		void remove(uint32_t proxy)
+		{
+			Expects(proxy < _nodes.size() && _nodes[proxy].leaf() && _nodes[proxy].height == 0);
+			if (_nodes[proxy].moved)
+				_moved.erase(std::find(_moved.begin(), _moved.end(), proxy));
+			_remove_leaf(proxy);
+			_release(proxy);
+			--_proxies;
+		}
+
+		// Gives the proxy its new box, reinserting it only if the box left its fat bounds, or if the fat bounds became
+		// much larger than needed after a fast move. The fat bounds then extend along 'displacement', the motion
+		// expected before the next move. Returns whether the fat bounds changed.
+		bool move(uint32_t proxy, const Bounds3<T>& box, const Vec3<T>& displacement = Vec3<T>(T(0)))
+		{
+			Expects(proxy < _nodes.size() && _nodes[proxy].leaf() && _nodes[proxy].height == 0);
+			const Bounds3<T>& fat = _nodes[proxy].box;
+			if (_contains(fat, box) && _contains(_fatten(box, displacement, U(4)), fat))
+				return false;
+			_remove_leaf(proxy);
+			_nodes[proxy].box = _fatten(box, displacement, U(1));
+			_insert_leaf(proxy);
+			_mark(proxy);
+			return true;
+		}
+
+		// Calls f(proxy) for every proxy whose fat bounds overlap 'box'
+		template <class F>
+		void overlap(const Bounds3<T>& box, F&& f) const
+		{
+			if (_root == null)
+				return;
+			// a depth first traversal holds at most one node per level
+			Expects(size_t(_nodes[_root].height) < max_depth);
+			uint32_t stack[max_depth];
+			size_t top = 0;
+			stack[top++] = _root;
+			while (top > 0)
+			{
+				const Node& node = _nodes[stack[--top]];
+				if (!intersect(node.box, box))
+					continue;
+				if (node.leaf())
+					f(uint32_t(&node - _nodes.data()));
+				else
+				{
+					stack[top++] = node.child[1];
+					stack[top++] = node.child[0];
+				}
+			}
+		}
+
+		// Calls f(a, b) with a < b once for every pair of proxies whose fat bounds overlap and of which at least one
+		// was inserted or had its fat bounds changed since the last call, then forgets those changes. Pairs of
+		// proxies that did not change were reported before, so the cost follows the number of changes.
+		template <class F>
+		void pairs(F&& f)
+		{
+			for (const uint32_t proxy : _moved)
+				overlap(_nodes[proxy].box, [&](uint32_t other)
+				{
+					// a pair of changed proxies is reported from the query of the smaller one
+					if (other != proxy && !(_nodes[other].moved && other < proxy))
+						f(std::min(proxy, other), std::max(proxy, other));
+				});
+			for (const uint32_t proxy : _moved)
+				_nodes[proxy].moved = false;
+			_moved.clear();
+		}
+	};
+
+	using AabbTreef = AabbTree<float>;
+	using AabbTreed = AabbTree<double>;
+}
+
+#define UVECTOR_AABBTREE_DEFINED
@@ -0,0 +1,413 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <new>
+
+#include "vector.h"
+
+namespace uv
+{
+	template <class T>
+	class ScalarArray;
+	template <class T, size_t N>
+	class VecArray;
+
+	namespace details
+	{
+		static constexpr size_t array_alignment = 64; // one cache line, also enough for any vector register
+
+		template <class T>
+		struct Broadcast
+		{
+			T value;
+			constexpr const T& operator[](size_t) const { return value; }
+		};
+
+		// Per-lane element source for array kernels; scalars and vectors are broadcast along the array
+		template <class S, class = if_scalar_t<S>> constexpr Broadcast<S> lane(const S& s, size_t) { return { s }; }
+		template <class S, size_t M, int L> constexpr Broadcast<S> lane(const Vec<S, M, L>& v, size_t k) { return { v[k] }; }
+		template <class S> const S* lane(const ScalarArray<S>& a, size_t) { return a.data(); }
+		template <class S, size_t M> const S* lane(const VecArray<S, M>& a, size_t k) { return a.lane(k); }
+
+		template <class S> constexpr size_t length_of(const S&) { return size_t(-1); }
+		template <class S> size_t length_of(const ScalarArray<S>& a) { return a.size(); }
+		template <class S, size_t M> size_t length_of(const VecArray<S, M>& a) { return a.size(); }
+
+		template <class OP, class R, class A, class B>
+		void apply_lane(R* result, const A& a, const B& b, size_t n)
+		{
+			OP op;
+			for (size_t i = 0; i < n; ++i)
+				result[i] = op(a[i], b[i]);
+		}
+
+		template <size_t N, class S> struct is_array_operand : std::bool_constant<is_scalar_v<S>> { };
+		template <size_t N, class S> struct is_array_operand<N, const S> : is_array_operand<N, S> { };
+		template <size_t N, class S> struct is_array_operand<N, S&> : is_array_operand<N, S> { };
+		template <size_t N, class S, size_t M, int K> struct is_array_operand<N, Vec<S, M, K>> : std::bool_constant<N == M> { };
+		template <size_t N, class S> struct is_array_operand<N, Dir<S, N>> : std::true_type { };
+		template <size_t N, class S> struct is_array_operand<N, ScalarArray<S>> : std::true_type { };
+
+		template <size_t N, class S> struct is_lane_source : is_array_operand<N, S> { };
+		template <size_t N, class S> struct is_lane_source<N, VecArray<S, N>> : std::true_type { };
+
+		template <size_t N, class S, class R = void>
+		using if_array_operand_t = std::enable_if_t<is_array_operand<N, S>::value, R>;
+
+		template <class T>
+		struct Scalar<ScalarArray<T>> { using type = T; };
+		template <class T, size_t N>
+		struct Scalar<VecArray<T, N>> { using type = T; };
+	}
+
+	// A contiguous, cache-line aligned array of scalars supporting element-wise arithmetic
+	template <class T>
+	class ScalarArray
+	{
+		static_assert(is_scalar_v<T>, "T must be a scalar type");
+		static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "T must be trivially copyable and destructible");
+
+		struct Deleter { void operator()(T* p) const { ::operator delete(p, std::align_val_t{ details::array_alignment }); } };
+
+		std::unique_ptr<T, Deleter> _data;
+		size_t _size = 0;
+		size_t _capacity = 0;
+
+		template <class S>
+		friend class ScalarArray;
+
+		template <class OP, class B>
+		auto _apply(const B& b) const
+		{
+			Expects(details::length_of(b) == size_t(-1) || details::length_of(b) == _size);
+			ScalarArray<type::of<OP, T, scalar<B>>> result(_size);
+			details::apply_lane<OP>(result.data(), data(), details::lane(b, 0), _size);
+			return result;
+		}
+		template <class OP, class B>
+		ScalarArray& _assign(const B& b)
+		{
+			Expects(details::length_of(b) == size_t(-1) || details::length_of(b) == _size);
+			details::apply_lane<OP>(data(), data(), details::lane(b, 0), _size);
+			return *this;
+		}
+	public:
+		using value_type = T;
+		using iterator = T*;
+		using const_iterator = const T*;
+
+		ScalarArray() = default;
+		explicit ScalarArray(size_t n) { resize(n); }
+		ScalarArray(size_t n, T value) { reserve(n); std::fill_n(data(), n, value); _size = n; }
+		ScalarArray(const ScalarArray& b) { reserve(b._size); std::copy_n(b.data(), b._size, data()); _size = b._size; }
+		ScalarArray(ScalarArray&& b) noexcept : _data(std::move(b._data)), _size(b._size), _capacity(b._capacity) { b._size = b._capacity = 0; }
+
+		ScalarArray& operator=(const ScalarArray& b) { if (this != &b) { resize(b._size); std::copy_n(b.data(), b._size, data()); } return *this; }
+		ScalarArray& operator=(ScalarArray&& b) noexcept { _data = std::move(b._data); _size = b._size; _capacity = b._capacity; b._size = b._capacity = 0; return *this; }
+
+		void reserve(size_t n)
+		{
+			if (n <= _capacity)
+				return;
+			// Round capacity up to whole cache lines so kernels may run over the padding
+			const size_t per_line = std::max<size_t>(1, details::array_alignment / sizeof(T));
+			n = (n + per_line - 1) / per_line * per_line;
+			std::unique_ptr<T, Deleter> grown(static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{ details::array_alignment })));
+			std::copy_n(_data.get(), _size, grown.get());
+			_data = std::move(grown);
+			_capacity = n;
+		}
+		void resize(size_t n)
+		{
+			reserve(n);
+			if (n > _size)
+				std::fill(data() + _size, data() + n, T(0));
+			_size = n;
+		}
+		void push_back(T value) { if (_size == _capacity) reserve(std::max<size_t>(2 * _capacity, 1)); data()[_size++] = value; }
+		void clear() { _size = 0; }
+
+		size_t size() const { return _size; }
+		bool empty() const { return _size == 0; }
+
+		      T* data()       { return _data.get(); }
+		const T* data() const { return _data.get(); }
+
+		      T* begin()       { return data(); }
+		const T* begin() const { return data(); }
+		      T* end()       { return data() + _size; }
+		const T* end() const { return data() + _size; }
+
+		      T& operator[](size_t i)       { return data()[i]; }
+		const T& operator[](size_t i) const { return data()[i]; }
+
+		ScalarArray<T> operator-() const { return T(0) - *this; }
+
+		template <class S, class = if_scalar_t<S>> friend auto operator+(const ScalarArray& a, S s) { return a._apply<op::add>(s); }
+		template <class S, class = if_scalar_t<S>> friend auto operator-(const ScalarArray& a, S s) { return a._apply<op::sub>(s); }
+		template <class S, class = if_scalar_t<S>> friend auto operator*(const ScalarArray& a, S s) { return a._apply<op::mul>(s); }
+		template <class S, class = if_scalar_t<S>> friend auto operator/(const ScalarArray& a, S s) { return a._apply<op::div>(s); }
+		template <class S, class = if_scalar_t<S>> friend auto operator+(S s, const ScalarArray& a) { return a._apply<op::rev<op::add>>(s); }
+		template <class S, class = if_scalar_t<S>> friend auto operator-(S s, const ScalarArray& a) { return a._apply<op::rev<op::sub>>(s); }
+		template <class S, class = if_scalar_t<S>> friend auto operator*(S s, const ScalarArray& a) { return a._apply<op::rev<op::mul>>(s); }
+		template <class S, class = if_scalar_t<S>> friend auto operator/(S s, const ScalarArray& a) { return a._apply<op::rev<op::div>>(s); }
+
+		template <class S, class = if_scalar_t<S>> friend auto operator==(const ScalarArray& a, S s) { return a._apply<op::eq>(s); }
+		template <class S, class = if_scalar_t<S>> friend auto operator< (const ScalarArray& a, S s) { return a._apply<op::sl>(s); }
+		template <class S, class = if_scalar_t<S>> friend auto operator==(S s, const ScalarArray& a) { return a._apply<op::rev<op::eq>>(s); }
+		template <class S, class = if_scalar_t<S>> friend auto operator< (S s, const ScalarArray& a) { return a._apply<op::rev<op::sl>>(s); }
+
+		template <class S> auto operator+(const ScalarArray<S>& b) const { return _apply<op::add>(b); }
+		template <class S> auto operator-(const ScalarArray<S>& b) const { return _apply<op::sub>(b); }
+		template <class S> auto operator*(const ScalarArray<S>& b) const { return _apply<op::mul>(b); }
+		template <class S> auto operator/(const ScalarArray<S>& b) const { return _apply<op::div>(b); }
+
+		template <class S> ScalarArray<bool> operator==(const ScalarArray<S>& b) const { return _apply<op::eq>(b); }
+		template <class S> ScalarArray<bool> operator< (const ScalarArray<S>& b) const { return _apply<op::sl>(b); }
+
+		template <class S> ScalarArray& operator+=(const S& b) { return _assign<op::add>(b); }
+		template <class S> ScalarArray& operator-=(const S& b) { return _assign<op::sub>(b); }
+		template <class S> ScalarArray& operator*=(const S& b) { return _assign<op::mul>(b); }
+		template <class S> ScalarArray& operator/=(const S& b) { return _assign<op::div>(b); }
+	};
+
+	// Structure-of-arrays storage for many N-dimensional vectors, one aligned scalar array per component
+	template <class T, size_t N>
+	class VecArray
+	{
+		std::array<ScalarArray<T>, N> _lanes;
+
+		template <class S, size_t M>
+		friend class VecArray;
+
+		template <class OP, class B>
+		auto _apply(const B& b) const
+		{
+			Expects(details::length_of(b) == size_t(-1) || details::length_of(b) == size());
+			VecArray<type::of<OP, T, scalar<B>>, N> result(size());
+			for (size_t k = 0; k < N; ++k)
+				details::apply_lane<OP>(result.lane(k), lane(k), details::lane(b, k), size());
+			return result;
+		}
+		template <class OP, class B>
+		VecArray& _assign(const B& b)
+		{
+			Expects(details::length_of(b) == size_t(-1) || details::length_of(b) == size());
+			for (size_t k = 0; k < N; ++k)
+				details::apply_lane<OP>(lane(k), lane(k), details::lane(b, k), size());
+			return *this;
+		}
+	public:
+		static_assert(N > 1, "vector arrays must have at least two dimensions");
+
+		using value_type = Vec<T, N>;
+		using scalar_type = T;
+
+		static constexpr size_t dim = N;
+
+		VecArray() = default;
+		explicit VecArray(size_t n) { resize(n); }
+		VecArray(size_t n, const Vec<T, N>& value) { for (size_t k = 0; k < N; ++k) _lanes[k] = ScalarArray<T>(n, value[k]); }
+		explicit VecArray(gsl::span<const Vec<T, N>> values) : VecArray(values.size())
+		{
+			for (size_t i = 0; i < size(); ++i)
+				for (size_t k = 0; k < N; ++k)
+					_lanes[k][i] = values[i][k];
+		}
+
+		// Writes the vectors back to array-of-structures layout
+		void store(gsl::span<Vec<T, N>> values) const
+		{
+			Expects(values.size() == size());
+			for (size_t i = 0; i < size(); ++i)
+				for (size_t k = 0; k < N; ++k)
+					values[i][k] = _lanes[k][i];
+		}
+
+		void reserve(size_t n) { for (auto& l : _lanes) l.reserve(n); }
+		void resize(size_t n) { for (auto& l : _lanes) l.resize(n); }
+		void clear() { for (auto& l : _lanes) l.clear(); }
+		template <class V, class = if_vector_t<N, V>>
+		void push_back(const V& v) { for (size_t k = 0; k < N; ++k) _lanes[k].push_back(details::Element(k).of(v)); }
+
+		size_t size() const { return _lanes[0].size(); }
+		bool empty() const { return _lanes[0].empty(); }
+
+		      T* lane(size_t k)       { return _lanes[k].data(); }
+		const T* lane(size_t k) const { return _lanes[k].data(); }
+
+		template <size_t I>       ScalarArray<T>& operator[](Axes<I>)       { static_assert(I < N, "Axis out of range"); return _lanes[I]; }
+		template <size_t I> const ScalarArray<T>& operator[](Axes<I>) const { static_assert(I < N, "Axis out of range"); return _lanes[I]; }
+
+		Vec<T, N> operator[](size_t i) const { Vec<T, N> v; for (size_t k = 0; k < N; ++k) v[k] = _lanes[k][i]; return v; }
+
+		template <class V, class = if_vector_t<N, V>>
+		void set(size_t i, const V& v) { for (size_t k = 0; k < N; ++k) _lanes[k][i] = details::Element(k).of(v); }
+
+		VecArray<T, N> operator-() const { return T(0) - *this; }
+
+		template <class S, class = details::if_array_operand_t<N, S>> friend auto operator+(const VecArray& a, const S& b) { return a._apply<op::add>(b); }
+		template <class S, class = details::if_array_operand_t<N, S>> friend auto operator-(const VecArray& a, const S& b) { return a._apply<op::sub>(b); }
+		template <class S, class = details::if_array_operand_t<N, S>> friend auto operator*(const VecArray& a, const S& b) { return a._apply<op::mul>(b); }
+		template <class S, class = details::if_array_operand_t<N, S>> friend auto operator/(const VecArray& a, const S& b) { return a._apply<op::div>(b); }
+		template <class S, class = details::if_array_operand_t<N, S>> friend auto operator+(const S& b, const VecArray& a) { return a._apply<op::rev<op::add>>(b); }
+		template <class S, class = details::if_array_operand_t<N, S>> friend auto operator-(const S& b, const VecArray& a) { return a._apply<op::rev<op::sub>>(b); }
+		template <class S, class = details::if_array_operand_t<N, S>> friend auto operator*(const S& b, const VecArray& a) { return a._apply<op::rev<op::mul>>(b); }
+		template <class S, class = details::if_array_operand_t<N, S>> friend auto operator/(const S& b, const VecArray& a) { return a._apply<op::rev<op::div>>(b); }
+
+		template <class S, class = details::if_array_operand_t<N, S>> friend VecArray<bool, N> operator==(const VecArray& a, const S& b) { return a._apply<op::eq>(b); }
+		template <class S, class = details::if_array_operand_t<N, S>> friend VecArray<bool, N> operator< (const VecArray& a, const S& b) { return a._apply<op::sl>(b); }
+		template <class S, class = details::if_array_operand_t<N, S>> friend VecArray<bool, N> operator==(const S& b, const VecArray& a) { return a._apply<op::rev<op::eq>>(b); }
+		template <class S, class = details::if_array_operand_t<N, S>> friend VecArray<bool, N> operator< (const S& b, const VecArray& a) { return a._apply<op::rev<op::sl>>(b); }
+
+		template <class S> auto operator+(const VecArray<S, N>& b) const { return _apply<op::add>(b); }
+		template <class S> auto operator-(const VecArray<S, N>& b) const { return _apply<op::sub>(b); }
+		template <class S> auto operator*(const VecArray<S, N>& b) const { return _apply<op::mul>(b); }
+		template <class S> auto operator/(const VecArray<S, N>& b) const { return _apply<op::div>(b); }
+
+		template <class S> VecArray<bool, N> operator==(const VecArray<S, N>& b) const { return _apply<op::eq>(b); }
+		template <class S> VecArray<bool, N> operator< (const VecArray<S, N>& b) const { return _apply<op::sl>(b); }
+
+		template <class S> VecArray& operator+=(const S& b) { return _assign<op::add>(b); }
+		template <class S> VecArray& operator-=(const S& b) { return _assign<op::sub>(b); }
+		template <class S> VecArray& operator*=(const S& b) { return _assign<op::mul>(b); }
+		template <class S> VecArray& operator/=(const S& b) { return _assign<op::div>(b); }
+	};
+
+	using float2array = VecArray<float, 2>;
+	using float3array = VecArray<float, 3>;
+	using float4array = VecArray<float, 4>;
+
+	using double2array = VecArray<double, 2>;
+	using double3array = VecArray<double, 3>;
+	using double4array = VecArray<double, 4>;
+
+	namespace details
+	{
+		template <size_t N, class A, class B>
+		auto dot_lanes(const A& a, const B& b, size_t n)
+		{
+			ScalarArray<type::mul<scalar<A>, scalar<B>>> result(n);
+			auto* r = result.data();
+			apply_lane<op::mul>(r, lane(a, 0), lane(b, 0), n);
+			for (size_t k = 1; k < N; ++k)
+			{
+				const auto la = lane(a, k);
+				const auto lb = lane(b, k);
+				for (size_t i = 0; i < n; ++i)
+					r[i] = r[i] + la[i] * lb[i];
+			}
+			return result;
+		}
+
+		template <class A, class B>
+		auto cross_lanes(const A& a, const B& b, size_t n)
+		{
+			VecArray<type::mul<scalar<A>, scalar<B>>, 3> result(n);
+			const auto ax = lane(a, 0), ay = lane(a, 1), az = lane(a, 2);
+			const auto bx = lane(b, 0), by = lane(b, 1), bz = lane(b, 2);
+			auto* rx = result.lane(0);
+			auto* ry = result.lane(1);
+			auto* rz = result.lane(2);
+			for (size_t i = 0; i < n; ++i)
+			{
+				rx[i] = ay[i] * bz[i] - az[i] * by[i];
+				ry[i] = az[i] * bx[i] - ax[i] * bz[i];
+				rz[i] = ax[i] * by[i] - ay[i] * bx[i];
+			}
+			return result;
+		}
+		template <class A, class B>
+		auto cross2_lanes(const A& a, const B& b, size_t n)
+		{
+			ScalarArray<type::mul<scalar<A>, scalar<B>>> result(n);
+			const auto ax = lane(a, 0), ay = lane(a, 1);
+			const auto bx = lane(b, 0), by = lane(b, 1);
+			auto* r = result.data();
+			for (size_t i = 0; i < n; ++i)
+				r[i] = ax[i] * by[i] - ay[i] * bx[i];
+			return result;
+		}
+	}
+
+	template <class A, class B, size_t N> auto dot(const VecArray<A, N>& a, const VecArray<B, N>& b) { Expects(a.size() == b.size()); return details::dot_lanes<N>(a, b, a.size()); }
+	template <class A, class B, size_t N, int K> auto dot(const VecArray<A, N>& a, const Vec<B, N, K>& b) { return details::dot_lanes<N>(a, b, a.size()); }
+	template <class A, class B, size_t N, int K> auto dot(const Vec<A, N, K>& a, const VecArray<B, N>& b) { return details::dot_lanes<N>(a, b, b.size()); }
+
+	template <class A, class B> auto cross(const VecArray<A, 3>& a, const VecArray<B, 3>& b) { Expects(a.size() == b.size()); return details::cross_lanes(a, b, a.size()); }
+	template <class A, class B, int K> auto cross(const VecArray<A, 3>& a, const Vec<B, 3, K>& b) { return details::cross_lanes(a, b, a.size()); }
+	template <class A, class B, int K> auto cross(const Vec<A, 3, K>& a, const VecArray<B, 3>& b) { return details::cross_lanes(a, b, b.size()); }
+
+	template <class A, class B> auto cross(const VecArray<A, 2>& a, const VecArray<B, 2>& b) { Expects(a.size() == b.size()); return details::cross2_lanes(a, b, a.size()); }
+	template <class A, class B, int K> auto cross(const VecArray<A, 2>& a, const Vec<B, 2, K>& b) { return details::cross2_lanes(a, b, a.size()); }
+	template <class A, class B, int K> auto cross(const Vec<A, 2, K>& a, const VecArray<B, 2>& b) { return details::cross2_lanes(a, b, b.size()); }
+
+	template <class T, size_t N> ScalarArray<type::mul<T>> square(const VecArray<T, N>& a) { return dot(a, a); }
+
+	template <class T>
+	auto sqrt(const ScalarArray<T>& a)
+	{
+		ScalarArray<std::decay_t<decltype(sqrt(std::declval<T>()))>> result(a.size());
+		for (size_t i = 0; i < a.size(); ++i)
+			result[i] = sqrt(a[i]);
+		return result;
+	}
+	template <class T>
+	ScalarArray<T> abs(const ScalarArray<T>& a)
+	{
+		ScalarArray<T> result(a.size());
+		for (size_t i = 0; i < a.size(); ++i)
+			result[i] = abs(a[i]);
+		return result;
+	}
+	template <class T, size_t N>
+	ScalarArray<T> length(const VecArray<T, N>& a)
+	{
+		auto s = square(a);
+		ScalarArray<T> result(a.size());
+		for (size_t i = 0; i < a.size(); ++i)
+			result[i] = sqrt(s[i]);
+		return result;
+	}
+
+	template <class T, size_t N>
+	ScalarArray<T> sum(const VecArray<T, N>& a)
+	{
+		ScalarArray<T> result(a[axes::X]);
+		for (size_t k = 1; k < N; ++k)
+			details::apply_lane<op::add>(result.data(), result.data(), a.lane(k), a.size());
+		return result;
+	}
+
+	template <size_t N> VecArray<bool, N> operator!(const VecArray<bool, N>& a) { return a == false; }
+	inline ScalarArray<bool> operator!(const ScalarArray<bool>& a) { return a == false; }
+
+	template <class A, class B, size_t N, class = std::enable_if_t<details::is_lane_source<N, A>::value && details::is_lane_source<N, B>::value>>
+	auto ifelse(const VecArray<bool, N>& cond, const A& a, const B& b)
+	{
+		VecArray<type::common<scalar<A>, scalar<B>>, N> result(cond.size());
+		for (size_t k = 0; k < N; ++k)
+		{
+			const bool* c = cond.lane(k);
+			const auto la = details::lane(a, k);
+			const auto lb = details::lane(b, k);
+			auto* r = result.lane(k);
+			for (size_t i = 0; i < cond.size(); ++i)
+				r[i] = c[i] ? la[i] : lb[i];
+		}
+		return result;
+	}
+	template <class A, class B, class = std::enable_if_t<details::is_array_operand<1, A>::value && details::is_array_operand<1, B>::value>>
+	auto ifelse(const ScalarArray<bool>& cond, const A& a, const B& b)
+	{
+		ScalarArray<type::common<scalar<A>, scalar<B>>> result(cond.size());
+		const auto la = details::lane(a, 0);
+		const auto lb = details::lane(b, 0);
+		for (size_t i = 0; i < cond.size(); ++i)
+			result[i] = cond[i] ? la[i] : lb[i];
+		return result;
+	}
+}
+
+#define UVECTOR_ARRAY_DEFINED
@@ -130,6 +130,16 @@ namespace uv
 	template <class T, size_t N, int K>
 	Vec<T, N> mean(const Vec<Bounds<T>, N, K>& v) { Vec<T, N> r; for (size_t i = 0; i < N; ++i) r[i] = mean(v[i]); return r; }
 
+	// The overlap of two boxes, axis by axis, which converts to false when they are disjoint along any axis
+	template <class A, class B, size_t N, int KA, int KB>
+	Vec<Bounds<type::common<A, B>>, N> intersect(const Vec<Bounds<A>, N, KA>& a, const Vec<Bounds<B>, N, KB>& b)
+	{
+		Vec<Bounds<type::common<A, B>>, N> r;
+		for (size_t i = 0; i < N; ++i)
+			r[i] = intersect(a[i], b[i]);
+		return r;
+	}
+
 	template <class T>
 	type::bounds<T> bounds(const T& last) { return type::bounds<T>(last); }
 	template <class A, class B>
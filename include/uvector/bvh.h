@@ -0,0 +1,324 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "bounds.h"
+#include "ray.h"
+
+namespace uv
+{
+	namespace details
+	{
+		template <class T>
+		Bounds3<T> empty_bounds3() { Bounds3<T> b; for (size_t i = 0; i < 3; ++i) b[i] = empty; return b; }
+
+		// bounds(b, x) in place, component by component, which the builder does for every box on every level
+		template <class T>
+		void grow(Bounds3<T>& b, const Bounds3<T>& x)
+		{
+			for (size_t i = 0; i < 3; ++i)
+			{
+				b[i].min = x[i].min < b[i].min ? x[i].min : b[i].min;
+				b[i].max = b[i].max < x[i].max ? x[i].max : b[i].max;
+			}
+		}
+		template <class T>
+		void grow(Bounds3<T>& b, const Vec3<T>& p)
+		{
+			for (size_t i = 0; i < 3; ++i)
+			{
+				b[i].min = p[i] < b[i].min ? p[i] : b[i].min;
+				b[i].max = b[i].max < p[i] ? p[i] : b[i].max;
+			}
+		}
+
+		// Half the surface area of a box, zero when it is empty
+		template <class T>
+		type::mul<T> half_area(const Bounds3<T>& b) { const auto e = span(b); return e[0]*e[1] + e[1]*e[2] + e[2]*e[0]; }
+
+		template <class T>
+		bool overlaps(const Bounds3<T>& a, const Bounds3<T>& b) { return all(min(a) <= max(b)) && all(min(b) <= max(a)); }
+
+		// Distance along the ray where it enters the box; false if it misses it or enters past 'tmax'
+		template <class T>
+		bool enters(const Ray3<T>& ray, const Bounds3<T>& b, T tmax, T& entry)
+		{
+			// a miss is empty, with an infinite min that an infinite tmax alone would not reject
+			const auto range = intersect(ray, b);
+			entry = min(range);
+			return bool(range) && entry <= tmax;
+		}
+	}
+
+	// Bounding volume hierarchy over a set of boxes, built with the binned surface area heuristic.
+	// The nodes are stored depth first in one array, with every inner node followed by its left child,
+	// and each node fills exactly 32 (float) or 64 (double) bytes.
+	template <class T>
+	class Bvh
+	{
+	public:
+		struct alignas(8*sizeof(T)) Node
+		{
+			Bounds3<T> box;
+			uint32_t offset; // index of the right child of an inner node, or of the first entry in indices() for a leaf
+			uint16_t count;  // number of boxes in a leaf, zero for inner nodes
+			uint16_t axis;   // split axis of an inner node
+
+			bool leaf() const { return count > 0; }
+		};
+
+		static constexpr size_t max_leaf_size = 8;
+		static constexpr size_t max_depth = 64;
+
+	private:
+		static constexpr size_t bin_count = 16;
+		static constexpr size_t sah_depth = max_depth/2; // deeper than this, nodes are split at the median to bound the depth
+
+		std::vector<Node> _nodes;
+		std::vector<uint32_t> _indices;
+		std::vector<Bounds3<T>> _boxes; // copies of the boxes in the order of _indices
+
+		struct Bin
+		{
+			Bounds3<T> box = details::empty_bounds3<T>();
+			size_t count = 0;
+		};
+
+		// The builder partitions these in place, so every pass over a node reads contiguous memory
+		struct Ref
+		{
+			Bounds3<T> box;
+			Vec3<T> center;
+			uint32_t index;
+		};
+		using RefIt = typename std::vector<Ref>::iterator;
+
+		// Chooses where to split [first, last) and reorders it accordingly, returning the first entry of the right child,
+		// or 'last' when the range is better kept as a leaf
+		static RefIt _split(RefIt first, RefIt last, const Bounds3<T>& box, size_t depth, size_t& axis)
+		{
+			using U = type::identity<T>;
+			const size_t n = size_t(last - first);
+			Bounds3<T> cbox = details::empty_bounds3<T>();
+			for (auto it = first; it != last; ++it)
+				details::grow(cbox, it->center);
+			const auto extent = span(cbox);
+			axis = extent[0] < extent[1] ? (extent[1] < extent[2] ? 2 : 1) : (extent[0] < extent[2] ? 2 : 0);
+
+			const auto median = [&]
+			{
+				if (n <= max_leaf_size)
+					return last;
+				const auto mid = first + n/2;
+				std::nth_element(first, mid, last, [&](const Ref& a, const Ref& b) { return a.center[axis] < b.center[axis]; });
+				return mid;
+			};
+			if (n <= 2 || depth >= sah_depth || !(extent[axis] > T(0)))
+				return median();
+
+			// costs in units of box tests, counting the traversal of a node as one
+			const auto leaf_cost = details::half_area(box) * U(n);
+			auto best_cost = details::half_area(box) * U(1) + leaf_cost;
+			size_t best_axis = 3, best_bin = 0;
+			// small nodes are most of the tree, and need no more bins than boxes
+			const size_t nb = std::min(bin_count, n);
+			for (size_t a = 0; a < 3; ++a)
+			{
+				if (!(extent[a] > T(0)))
+					continue;
+				const auto scale = U(nb) / extent[a];
+				Bin bins[bin_count];
+				for (auto it = first; it != last; ++it)
+				{
+					Bin& bin = bins[std::min(nb - 1, size_t((it->center[a] - min(cbox[a])) * scale))];
+					details::grow(bin.box, it->box);
+					++bin.count;
+				}
+				// sweep from the right and then from the left, evaluating the split after every bin
+				decltype(best_cost) right_cost[bin_count];
+				Bounds3<T> acc = details::empty_bounds3<T>();
+				size_t count = 0;
+				for (size_t k = nb - 1; k > 0; --k)
+				{
+					details::grow(acc, bins[k].box);
+					count += bins[k].count;
+					right_cost[k] = details::half_area(acc) * U(count);
+				}
+				acc = details::empty_bounds3<T>();
+				count = 0;
+				for (size_t k = 0; k + 1 < nb; ++k)
+				{
+					details::grow(acc, bins[k].box);
+					count += bins[k].count;
+					const auto cost = details::half_area(box) * U(1) + details::half_area(acc) * U(count) + right_cost[k + 1];
+					if (count > 0 && count < n && cost < best_cost)
+					{
+						best_cost = cost;
+						best_axis = a;
+						best_bin = k;
+					}
+				}
+			}
+			if (best_axis == 3 || (n <= max_leaf_size && !(best_cost < leaf_cost)))
+				return median();
+
+			axis = best_axis;
+			const auto scale = U(nb) / extent[axis];
+			return std::partition(first, last, [&](const Ref& r)
+			{
+				return std::min(nb - 1, size_t((r.center[axis] - min(cbox[axis])) * scale)) <= best_bin;
+			});
+		}
+
+	public:
+		Bvh() = default;
+		explicit Bvh(gsl::span<const Bounds3<T>> boxes) { build(boxes); }
+
+		void build(gsl::span<const Bounds3<T>> boxes)
+		{
+			_nodes.clear();
+			std::vector<Ref> refs(boxes.size());
+			for (size_t i = 0; i < refs.size(); ++i)
+				refs[i] = { boxes[i], mean(boxes[i]), uint32_t(i) };
+			if (!refs.empty())
+			{
+				_nodes.reserve(2*refs.size());
+
+				struct Task { size_t first, last, depth, parent; };
+				std::vector<Task> tasks = { { 0, refs.size(), 0, size_t(-1) } };
+				while (!tasks.empty())
+				{
+					const Task task = tasks.back();
+					tasks.pop_back();
+					if (task.parent != size_t(-1))
+						_nodes[task.parent].offset = uint32_t(_nodes.size());
+
+					Node node{};
+					node.box = details::empty_bounds3<T>();
+					for (size_t i = task.first; i < task.last; ++i)
+						details::grow(node.box, refs[i].box);
+					size_t axis = 0;
+					const size_t mid = size_t(_split(refs.begin() + task.first, refs.begin() + task.last, node.box, task.depth, axis) - refs.begin());
+					node.axis = uint16_t(axis);
+					if (mid == task.last)
+					{
+						node.offset = uint32_t(task.first);
+						node.count = uint16_t(task.last - task.first);
+						_nodes.push_back(node);
+						continue;
+					}
+					node.count = 0;
+					_nodes.push_back(node);
+					// the left child is taken next, so it lands right after its parent
+					tasks.push_back({ mid, task.last, task.depth + 1, _nodes.size() - 1 });
+					tasks.push_back({ task.first, mid, task.depth + 1, size_t(-1) });
+				}
+			}
+			_indices.resize(refs.size());
+			_boxes.resize(refs.size());
+			for (size_t i = 0; i < refs.size(); ++i)
+			{
+				_indices[i] = refs[i].index;
+				_boxes[i] = refs[i].box;
+			}
+		}
+
+		// Recomputes the node boxes after the boxes have moved, keeping the structure of the tree
+		void refit(gsl::span<const Bounds3<T>> boxes)
+		{
+			Expects(size_t(boxes.size()) == _indices.size());
+			// children come after their parents, so a backward pass sees them first
+			for (size_t i = _nodes.size(); i-- > 0;)
+			{
+				Node& node = _nodes[i];
+				if (node.leaf())
+				{
+					node.box = details::empty_bounds3<T>();
+					for (size_t j = node.offset; j < node.offset + node.count; ++j)
+					{
+						_boxes[j] = boxes[_indices[j]];
+						details::grow(node.box, _boxes[j]);
+					}
+				}
+				else
+					node.box = bounds(_nodes[i + 1].box, _nodes[node.offset].box);
+			}
+		}
+
+		// Calls f(index) for every box overlapping 'box'
+		template <class F>
+		void overlap(const Bounds3<T>& box, F&& f) const
+		{
+			if (_nodes.empty())
+				return;
+			uint32_t stack[max_depth];
+			size_t top = 0;
+			stack[top++] = 0;
+			while (top > 0)
+			{
+				const Node& node = _nodes[stack[--top]];
+				if (!details::overlaps(node.box, box))
+					continue;
+				if (node.leaf())
+				{
+					for (size_t j = node.offset; j < node.offset + node.count; ++j)
+						if (details::overlaps(_boxes[j], box))
+							f(size_t(_indices[j]));
+					continue;
+				}
+				stack[top++] = node.offset;
+				stack[top++] = uint32_t(&node - _nodes.data()) + 1;
+			}
+		}
+
+		// Calls f(index, tmax) for every box hit by ray(t) with 0 <= t <= tmax, visiting nearer nodes first.
+		// f can lower tmax to the distance of a confirmed hit on the object inside the box, culling everything further away.
+		template <class F>
+		void raycast(const Ray3<T>& ray, T tmax, F&& f) const
+		{
+			if (_nodes.empty())
+				return;
+			uint32_t stack[max_depth];
+			size_t top = 0;
+			T entry;
+			if (!details::enters(ray, _nodes[0].box, tmax, entry))
+				return;
+			stack[top++] = 0;
+			while (top > 0)
+			{
+				const uint32_t index = stack[--top];
+				const Node& node = _nodes[index];
+				if (node.leaf())
+				{
+					// the node was tested when pushed, but tmax may have shrunk since
+					if (!details::enters(ray, node.box, tmax, entry))
+						continue;
+					for (size_t j = node.offset; j < node.offset + node.count; ++j)
+						if (details::enters(ray, _boxes[j], tmax, entry))
+							f(size_t(_indices[j]), tmax);
+					continue;
+				}
+				T left_entry, right_entry;
+				const bool left = details::enters(ray, _nodes[index + 1].box, tmax, left_entry);
+				const bool right = details::enters(ray, _nodes[node.offset].box, tmax, right_entry);
+				if (left && right)
+				{
+					const bool left_first = left_entry <= right_entry;
+					stack[top++] = left_first ? node.offset : index + 1;
+					stack[top++] = left_first ? index + 1 : node.offset;
+				}
+				else if (left)
+					stack[top++] = index + 1;
+				else if (right)
+					stack[top++] = node.offset;
+			}
+		}
+
+		const std::vector<Node>& nodes() const { return _nodes; }
+		const std::vector<uint32_t>& indices() const { return _indices; }
+	};
+}
+
+#define UVECTOR_BVH_DEFINED
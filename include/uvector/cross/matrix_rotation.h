@@ -2,27 +2,83 @@
 
 #include "../matrix.h"
 #include "../rotation.h"
+#include "../array.h"
 
 namespace uv
 {
+	namespace details
+	{
+		// Shepperd's method: each of w, x, y, z gives a candidate 4*q_i*q from the matrix elements, and the one with the
+		// largest |q_i| is best conditioned. Candidates are selected by value rather than branched to, so a loop over
+		// many matrices vectorizes. One square root, for the normalization; the result has re >= 0.
+		template <class T>
+		void shepperd(const T (&m)[3][3], T& re, T (&im)[3])
+		{
+			const T one = 1;
+			// 4*w*w, 4*x*x, 4*y*y, 4*z*z
+			const T dw = one + m[0][0] + m[1][1] + m[2][2];
+			const T dx = one + m[0][0] - m[1][1] - m[2][2];
+			const T dy = one - m[0][0] + m[1][1] - m[2][2];
+			const T dz = one - m[0][0] - m[1][1] + m[2][2];
+			const T wx = m[2][1] - m[1][2], wy = m[0][2] - m[2][0], wz = m[1][0] - m[0][1];
+			const T xy = m[0][1] + m[1][0], xz = m[0][2] + m[2][0], yz = m[1][2] + m[2][1];
+
+			const auto x_over_w = dx > dw;
+			const auto z_over_y = dz > dy;
+			const auto zy_over_xw = max(dy, dz) > max(dw, dx);
+			const auto pick = [&](T w, T x, T y, T z) { return ifelse(zy_over_xw, ifelse(z_over_y, z, y), ifelse(x_over_w, x, w)); };
+
+			T c[4] = {
+				pick(dw, wx, wy, wz),
+				pick(wx, dx, xy, xz),
+				pick(wy, xy, dy, yz),
+				pick(wz, xz, yz, dz) };
+			const T f = ifelse(c[0] < T(0), -one, one) * lane_rsqrt(c[0]*c[0] + c[1]*c[1] + c[2]*c[2] + c[3]*c[3]);
+			re = c[0]*f;
+			for (size_t i = 0; i < 3; ++i)
+				im[i] = c[i + 1]*f;
+		}
+	}
+
+	// 'm' must be a rotation matrix
 	template <class T, size_t R, size_t C>
 	Quat<T> quaternion(const Mat<T, R, C>& m)
 	{
 		static_assert(R == 3 && C == 3, "Only 3x3 matrices can be converted to quaternions");
 
-		// from http://www.euclideanspace.com/maths/geometry/rotations/conversions/matrixToQuaternion/
-		// TODO: presicion for quaternion-matrix-quaternion roundtrip is poor for floats, force conversion to double?
-
-		using namespace axes;
-
-		const auto scale = cbrt(det(m));
+		T a[3][3], re, im[3];
+		for (size_t i = 0; i < 3; ++i)
+			for (size_t j = 0; j < 3; ++j)
+				a[i][j] = rows(m)[i][j];
+		details::shepperd(a, re, im);
+		return quaternion(re, vector(im[0], im[1], im[2]));
+	}
 
-		auto& mr = rows(m);
-		return quaternion(sqrt(std::max(T(0), scale + mr[0][0] + mr[1][1] + mr[2][2])) / 2,
-			vector(
-			copysign(sqrt(std::max(T(0), scale + mr[0][0] - mr[1][1] - mr[2][2])) / 2, mr[2][1] - mr[1][2]),
-			copysign(sqrt(std::max(T(0), scale - mr[0][0] + mr[1][1] - mr[2][2])) / 2, mr[0][2] - mr[2][0]),
-			copysign(sqrt(std::max(T(0), scale - mr[0][0] - mr[1][1] + mr[2][2])) / 2, mr[1][0] - mr[0][1])   ));
+	// Converts many rotation matrices, a lane group at a time: the group is transposed to structure-of-arrays so that
+	// the conversion loop runs over contiguous elements. GCC and Clang need -fno-math-errno to vectorize its sqrt.
+	template <class T>
+	void quaternion(gsl::span<const Mat<T, 3, 3>> m, gsl::span<Quat<T>> q)
+	{
+		using L = Vec<T, details::lane_group<T>>;
+		Expects(q.size() == m.size());
+		for (size_t first = 0; first < size_t(m.size()); first += dim<L>)
+		{
+			L a[3][3], re, im[3];
+			const size_t n = details::gather_lanes(m, first, a);
+			for (size_t k = 0; k < dim<L>; ++k)
+			{
+				const T mk[3][3] = {
+					{ a[0][0][k], a[0][1][k], a[0][2][k] },
+					{ a[1][0][k], a[1][1][k], a[1][2][k] },
+					{ a[2][0][k], a[2][1][k], a[2][2][k] } };
+				T imk[3];
+				details::shepperd(mk, re[k], imk);
+				for (size_t i = 0; i < 3; ++i)
+					im[i][k] = imk[i];
+			}
+			for (size_t k = 0; k < n; ++k)
+				q[first + k] = quaternion(re[k], vector(im[0][k], im[1][k], im[2][k]));
+		}
 	}
 
 	template <class T>
@@ -55,4 +111,75 @@ namespace uv
 		return rotation(quaternion(m));
 	}
 
+	namespace details
+	{
+		// out = m*in + t over many vectors, with the matrix expanded once and held in locals for the whole batch
+		template <class M, class S, class R>
+		void affine_transform(const Mat<M, 3, 3>& m, const Vec3<R>& t, const Vec3<S>* in, Vec3<R>* out, size_t n)
+		{
+			auto& mr = rows(m);
+			const M m00 = mr[0][0], m01 = mr[0][1], m02 = mr[0][2];
+			const M m10 = mr[1][0], m11 = mr[1][1], m12 = mr[1][2];
+			const M m20 = mr[2][0], m21 = mr[2][1], m22 = mr[2][2];
+			const R t0 = t[0], t1 = t[1], t2 = t[2];
+			for (size_t i = 0; i < n; ++i)
+			{
+				const S x = in[i][0], y = in[i][1], z = in[i][2];
+				out[i][0] = m00*x + m01*y + m02*z + t0;
+				out[i][1] = m10*x + m11*y + m12*z + t1;
+				out[i][2] = m20*x + m21*y + m22*z + t2;
+			}
+		}
+		template <class M, class S, class R>
+		void affine_transform(const Mat<M, 3, 3>& m, const Vec3<R>& t, const VecArray<S, 3>& in, VecArray<R, 3>& out)
+		{
+			out.resize(in.size());
+			auto& mr = rows(m);
+			const M m00 = mr[0][0], m01 = mr[0][1], m02 = mr[0][2];
+			const M m10 = mr[1][0], m11 = mr[1][1], m12 = mr[1][2];
+			const M m20 = mr[2][0], m21 = mr[2][1], m22 = mr[2][2];
+			const R t0 = t[0], t1 = t[1], t2 = t[2];
+			const S* x = in.lane(0);
+			const S* y = in.lane(1);
+			const S* z = in.lane(2);
+			R* ox = out.lane(0);
+			R* oy = out.lane(1);
+			R* oz = out.lane(2);
+			for (size_t i = 0; i < in.size(); ++i)
+			{
+				const S xi = x[i], yi = y[i], zi = z[i];
+				ox[i] = m00*xi + m01*yi + m02*zi + t0;
+				oy[i] = m10*xi + m11*yi + m12*zi + t1;
+				oz[i] = m20*xi + m21*yi + m22*zi + t2;
+			}
+		}
+	}
+
+	// Rotates every vector of 'in' into 'out'; 'in' and 'out' may be the same span
+	template <class T, class S>
+	void transform(const Rot3<T>& r, gsl::span<const Vec3<S>> in, gsl::span<Vec3<S>> out)
+	{
+		Expects(in.size() == out.size());
+		details::affine_transform(matrix(r), Vec3<S>(S(0)), in.data(), out.data(), in.size());
+	}
+	template <class T, class S>
+	void transform(const Rot3<T>& r, const VecArray<S, 3>& in, VecArray<S, 3>& out)
+	{
+		details::affine_transform(matrix(r), Vec3<S>(S(0)), in, out);
+	}
+
+	template <class T, class S>
+	void transform(const Quat<T>& q, gsl::span<const Vec3<S>> in, gsl::span<Vec3<S>> out)
+	{
+		Expects(nearUnit(q));
+		Expects(in.size() == out.size());
+		details::affine_transform(matrix(q), Vec3<S>(S(0)), in.data(), out.data(), in.size());
+	}
+	template <class T, class S>
+	void transform(const Quat<T>& q, const VecArray<S, 3>& in, VecArray<S, 3>& out)
+	{
+		Expects(nearUnit(q));
+		details::affine_transform(matrix(q), Vec3<S>(S(0)), in, out);
+	}
+
 }
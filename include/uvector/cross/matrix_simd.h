@@ -0,0 +1,179 @@
+#pragma once
+
+#include "../matrix.h"
+#include "../simd.h"
+
+namespace uv
+{
+	namespace details
+	{
+		inline void transpose4(__m128 (&c)[4])
+		{
+			_MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);
+		}
+#ifdef __AVX__
+		inline void transpose4(__m256d (&c)[4])
+		{
+			const __m256d t0 = _mm256_unpacklo_pd(c[0], c[1]); // c0[0] c1[0] c0[2] c1[2]
+			const __m256d t1 = _mm256_unpackhi_pd(c[0], c[1]); // c0[1] c1[1] c0[3] c1[3]
+			const __m256d t2 = _mm256_unpacklo_pd(c[2], c[3]);
+			const __m256d t3 = _mm256_unpackhi_pd(c[2], c[3]);
+			c[0] = _mm256_permute2f128_pd(t0, t2, 0x20);
+			c[1] = _mm256_permute2f128_pd(t1, t3, 0x20);
+			c[2] = _mm256_permute2f128_pd(t0, t2, 0x31);
+			c[3] = _mm256_permute2f128_pd(t1, t3, 0x31);
+		}
+#endif
+
+		// The four columns of a 4x4 matrix held in registers
+		template <class T>
+		class PackedColumns
+		{
+			using R = simd::Register<T>;
+			typename R::type _c[4];
+		public:
+			explicit PackedColumns(const Mat<T, 4, 4>& m)
+			{
+				for (size_t i = 0; i < 4; ++i)
+					_c[i] = R::load(m.data() + 4*i);
+			}
+
+			// M * v = M0*v0 + M1*v1 + M2*v2 + M3*v3, with each vi broadcast from memory
+			typename R::type operator*(const T* v) const
+			{
+				return R::add(
+					R::add(R::mul(_c[0], R::broadcast(v[0])), R::mul(_c[1], R::broadcast(v[1]))),
+					R::add(R::mul(_c[2], R::broadcast(v[2])), R::mul(_c[3], R::broadcast(v[3]))));
+			}
+
+			Mat<T, 4, 4> transposed() const
+			{
+				typename R::type c[4] = { _c[0], _c[1], _c[2], _c[3] };
+				transpose4(c);
+				Mat<T, 4, 4> result;
+				for (size_t i = 0; i < 4; ++i)
+					R::store(result.data() + 4*i, c[i]);
+				return result;
+			}
+		};
+
+		// Cramer's rule with the 2x2 sub-determinants shared between cofactors (Intel AP-928). Since inv(M^T) = inv(M)^T,
+		// the same code serves column-major storage.
+		inline float44 packed_invert(const float44& m)
+		{
+			__m128 r[4] = { _mm_loadu_ps(m.data()), _mm_loadu_ps(m.data() + 4), _mm_loadu_ps(m.data() + 8), _mm_loadu_ps(m.data() + 12) };
+			transpose4(r);
+			// the cofactor expansion pairs rows 0/1 and 2/3 with their halves swapped
+			__m128 row0 = r[0];
+			__m128 row1 = _mm_shuffle_ps(r[1], r[1], 0x4E);
+			__m128 row2 = r[2];
+			__m128 row3 = _mm_shuffle_ps(r[3], r[3], 0x4E);
+			__m128 minor0, minor1, minor2, minor3, tmp;
+
+			tmp = _mm_mul_ps(row2, row3);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+			minor0 = _mm_mul_ps(row1, tmp);
+			minor1 = _mm_mul_ps(row0, tmp);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+			minor0 = _mm_sub_ps(_mm_mul_ps(row1, tmp), minor0);
+			minor1 = _mm_sub_ps(_mm_mul_ps(row0, tmp), minor1);
+			minor1 = _mm_shuffle_ps(minor1, minor1, 0x4E);
+
+			tmp = _mm_mul_ps(row1, row2);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+			minor0 = _mm_add_ps(_mm_mul_ps(row3, tmp), minor0);
+			minor3 = _mm_mul_ps(row0, tmp);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+			minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row3, tmp));
+			minor3 = _mm_sub_ps(_mm_mul_ps(row0, tmp), minor3);
+			minor3 = _mm_shuffle_ps(minor3, minor3, 0x4E);
+
+			tmp = _mm_mul_ps(_mm_shuffle_ps(row1, row1, 0x4E), row3);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+			row2 = _mm_shuffle_ps(row2, row2, 0x4E);
+			minor0 = _mm_add_ps(_mm_mul_ps(row2, tmp), minor0);
+			minor2 = _mm_mul_ps(row0, tmp);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+			minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row2, tmp));
+			minor2 = _mm_sub_ps(_mm_mul_ps(row0, tmp), minor2);
+			minor2 = _mm_shuffle_ps(minor2, minor2, 0x4E);
+
+			tmp = _mm_mul_ps(row0, row1);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+			minor2 = _mm_add_ps(_mm_mul_ps(row3, tmp), minor2);
+			minor3 = _mm_sub_ps(_mm_mul_ps(row2, tmp), minor3);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+			minor2 = _mm_sub_ps(_mm_mul_ps(row3, tmp), minor2);
+			minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row2, tmp));
+
+			tmp = _mm_mul_ps(row0, row3);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+			minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row2, tmp));
+			minor2 = _mm_add_ps(_mm_mul_ps(row1, tmp), minor2);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+			minor1 = _mm_add_ps(_mm_mul_ps(row2, tmp), minor1);
+			minor2 = _mm_sub_ps(minor2, _mm_mul_ps(row1, tmp));
+
+			tmp = _mm_mul_ps(row0, row2);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+			minor1 = _mm_add_ps(_mm_mul_ps(row3, tmp), minor1);
+			minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row1, tmp));
+			tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+			minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row3, tmp));
+			minor3 = _mm_add_ps(_mm_mul_ps(row1, tmp), minor3);
+
+			__m128 det = _mm_mul_ps(row0, minor0);
+			det = _mm_add_ps(_mm_shuffle_ps(det, det, 0x4E), det);
+			det = _mm_add_ps(_mm_shuffle_ps(det, det, 0xB1), det);
+			det = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+			float44 result;
+			_mm_storeu_ps(result.data(),      _mm_mul_ps(det, minor0));
+			_mm_storeu_ps(result.data() + 4,  _mm_mul_ps(det, minor1));
+			_mm_storeu_ps(result.data() + 8,  _mm_mul_ps(det, minor2));
+			_mm_storeu_ps(result.data() + 12, _mm_mul_ps(det, minor3));
+			return result;
+		}
+
+		template <class T>
+		Mat<T, 4, 4> packed_multiply(const Mat<T, 4, 4>& a, const Mat<T, 4, 4>& b)
+		{
+			const PackedColumns<T> pa(a);
+			Mat<T, 4, 4> result;
+			for (size_t i = 0; i < 4; ++i)
+				simd::Register<T>::store(result.data() + 4*i, pa * (b.data() + 4*i));
+			return result;
+		}
+		template <class T>
+		Vec<T, 4> packed_multiply(const Mat<T, 4, 4>& m, const Vec<T, 4>& v)
+		{
+			Vec<T, 4> result;
+			simd::Register<T>::store(&result[0], PackedColumns<T>(m) * &v[0]);
+			return result;
+		}
+		template <class T>
+		void packed_transform(const Mat<T, 4, 4>& m, gsl::span<const Vec<T, 4>> in, gsl::span<Vec<T, 4>> out)
+		{
+			Expects(in.size() == out.size());
+			const PackedColumns<T> pm(m);
+			for (size_t i = 0; i < size_t(in.size()); ++i)
+				simd::Register<T>::store(&out[i][0], pm * &in[i][0]);
+		}
+	}
+
+	inline float44 operator*(const float44& a, const float44& b) { return details::packed_multiply(a, b); }
+	inline float4  operator*(const float44& m, const float4& v)  { return details::packed_multiply(m, v); }
+	inline float44 transpose(const float44& m) { return details::PackedColumns<float>(m).transposed(); }
+	inline float44 invert(const float44& m) { return details::packed_invert(m); }
+
+	// Multiplies every vector of 'in' by 'm', keeping the matrix in registers for the whole batch; 'in' and 'out' may be the same span
+	inline void transform(const float44& m, gsl::span<const float4> in, gsl::span<float4> out) { details::packed_transform(m, in, out); }
+
+#ifdef __AVX__
+	inline double44 operator*(const double44& a, const double44& b) { return details::packed_multiply(a, b); }
+	inline double4  operator*(const double44& m, const double4& v)  { return details::packed_multiply(m, v); }
+	inline double44 transpose(const double44& m) { return details::PackedColumns<double>(m).transposed(); }
+
+	inline void transform(const double44& m, gsl::span<const double4> in, gsl::span<double4> out) { details::packed_transform(m, in, out); }
+#endif
+}
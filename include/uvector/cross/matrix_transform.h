@@ -17,4 +17,55 @@ namespace uv
 			tf.t/T(1) + W);
 	}
 
+	template <class T>
+	Mat<type::identity<T>, 4, 4> homogeneous(const Sim3<T>& tf)
+	{
+		using namespace axes;
+		auto R = matrix(tf.r) * tf.s;
+		return cols(
+			R*X + W(0),
+			R*Y + W(0),
+			R*Z + W(0),
+			tf.t/T(1) + W);
+	}
+
+	// Applies 'tf' to every point of 'in', writing the results to 'out'; 'in' and 'out' may be the same span
+	template <class T>
+	void transform(const Trans3<T>& tf, gsl::span<const Point3<T>> in, gsl::span<Point3<T>> out)
+	{
+		Expects(in.size() == out.size());
+		details::affine_transform(matrix(tf.r), tf.t, reinterpret_cast<const Vec3<T>*>(in.data()), reinterpret_cast<Vec3<T>*>(out.data()), in.size());
+	}
+	// Vectors are only rotated
+	template <class T>
+	void transform(const Trans3<T>& tf, gsl::span<const Vec3<T>> in, gsl::span<Vec3<T>> out)
+	{
+		transform(tf.r, in, out);
+	}
+	// Structure-of-arrays coordinates are taken to be points
+	template <class T>
+	void transform(const Trans3<T>& tf, const VecArray<T, 3>& points, VecArray<T, 3>& out)
+	{
+		details::affine_transform(matrix(tf.r), tf.t, points, out);
+	}
+
+	// The same for similarity transforms, through the rotation matrix times the scale
+	template <class T>
+	void transform(const Sim3<T>& tf, gsl::span<const Point3<T>> in, gsl::span<Point3<T>> out)
+	{
+		Expects(in.size() == out.size());
+		details::affine_transform(matrix(tf.r) * tf.s, tf.t, reinterpret_cast<const Vec3<T>*>(in.data()), reinterpret_cast<Vec3<T>*>(out.data()), in.size());
+	}
+	// Vectors are rotated and scaled
+	template <class T>
+	void transform(const Sim3<T>& tf, gsl::span<const Vec3<T>> in, gsl::span<Vec3<T>> out)
+	{
+		Expects(in.size() == out.size());
+		details::affine_transform(matrix(tf.r) * tf.s, Vec3<T>(T(0)), in.data(), out.data(), in.size());
+	}
+	template <class T>
+	void transform(const Sim3<T>& tf, const VecArray<T, 3>& points, VecArray<T, 3>& out)
+	{
+		details::affine_transform(matrix(tf.r) * tf.s, tf.t, points, out);
+	}
 }
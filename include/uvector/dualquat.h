@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "array.h"
+#include "transform.h"
+
+namespace uv
+{
+	// A rigid transform as a unit dual quaternion, real + e*dual with e*e = 0: the real part is the rotation and the dual
+	// part half the translation times it. A weighted sum of unit dual quaternions, normalized, is again a rigid
+	// transform, rotating about a single screw axis, so blending them does not shrink the result like blending matrices.
+	template <class T>
+	class DualQuat
+	{
+		using U = type::identity<T>;
+	public:
+		Quat<U> real;
+		Quat<T> dual;
+
+		DualQuat() { }
+		DualQuat(Identity) : real(identity), dual(T(0), Vec3<T>(T(0))) { }
+		DualQuat(const Quat<U>& real, const Quat<T>& dual) : real(real), dual(dual) { }
+		template <class W>
+		DualQuat(const Rot3<W>& r) : real(quaternion(r)), dual(T(0), Vec3<T>(T(0))) { }
+		DualQuat(const Trans3<T>& tf) : real(quaternion(tf.r)), dual(quaternion(T(0), tf.t) * quaternion(tf.r) * U(0.5)) { }
+
+		// The rotation and translation of a unit dual quaternion
+		explicit operator Trans3<T>() const { return { Rot3<U>::fromUnchecked(real), translation(*this) }; }
+
+		friend Vec3<T> translation(const DualQuat& dq) { return (dq.dual * conjugate(dq.real)).im * U(2); }
+
+		friend DualQuat conjugate(const DualQuat& dq) { return { conjugate(dq.real), conjugate(dq.dual) }; }
+		friend DualQuat invert(const DualQuat& dq) { return conjugate(dq); }
+
+		DualQuat operator-() const { return { -real, -dual }; }
+
+		template <class S, class = if_scalar_t<S>> friend DualQuat operator*(const DualQuat& dq, S s) { return { dq.real * s, dq.dual * s }; }
+		template <class S, class = if_scalar_t<S>> friend DualQuat operator*(S s, const DualQuat& dq) { return dq * s; }
+		DualQuat operator+(const DualQuat& b) const { return { real + b.real, dual + b.dual }; }
+		DualQuat operator-(const DualQuat& b) const { return { real - b.real, dual - b.dual }; }
+
+		DualQuat operator*(const DualQuat& b) const { return { real * b.real, real * b.dual + dual * b.real }; }
+		DualQuat& operator*=(const DualQuat& b) { *this = *this * b; return *this; }
+
+		template <class S, int K> friend auto operator*(const DualQuat& dq, const Vec<S, 3, K>& v) { return dq.real * v; }
+		friend Point3<T> operator*(const DualQuat& dq, const Point3<T>& p) { return point(dq.real * p.v + translation(dq)); }
+	};
+	using DualQuatf = DualQuat<float>;
+	using DualQuatd = DualQuat<double>;
+
+	// Dual quaternion linear blending, after Kavan et al., "Skinning with Dual Quaternions" (2007): the weighted sum of
+	// the transforms, each taken with the sign of its real part nearest to the first, normalized to a rigid transform.
+	template <class T>
+	DualQuat<T> blend(gsl::span<const DualQuat<T>> dqs, gsl::span<const type::identity<T>> weights)
+	{
+		using U = type::identity<T>;
+		Expects(!dqs.empty() && dqs.size() == weights.size());
+		DualQuat<T> sum = dqs[0] * weights[0];
+		for (size_t i = 1; i < size_t(dqs.size()); ++i)
+			sum = sum + dqs[i] * (dot(dqs[0].real, dqs[i].real) < U(0) ? -weights[i] : weights[i]);
+		const U inv = U(1) / length(sum.real);
+		sum = sum * inv;
+		// the dual part of a unit dual quaternion is orthogonal to the real part, and the rest of the sum does not move points
+		sum.dual = sum.dual - sum.real * dot(sum.real, sum.dual);
+		return sum;
+	}
+
+	template <class T>
+	DualQuat<T> blend(const DualQuat<T>& a, const DualQuat<T>& b, type::identity<T> t)
+	{
+		using U = type::identity<T>;
+		const DualQuat<T> dqs[2] = { a, b };
+		const U weights[2] = { U(1) - t, t };
+		return blend(gsl::span<const DualQuat<T>>(dqs, 2), gsl::span<const U>(weights, 2));
+	}
+
+	// The joints and weights of up to four influences on each vertex, in structure-of-arrays form: influence k of
+	// vertex i is joint joints.lane(k)[i] with weight weights.lane(k)[i]. Unused influences have weight zero.
+	template <class U>
+	struct SkinWeights
+	{
+		VecArray<uint32_t, 4> joints;
+		VecArray<U, 4> weights;
+
+		size_t size() const { return joints.size(); }
+	};
+
+	namespace details
+	{
+		static constexpr size_t skin_block = 64;
+
+		// The components of the joints, re then im, in lanes that the skinning kernel gathers from
+		template <class T>
+		void joint_lanes(gsl::span<const DualQuat<T>> joints, VecArray<type::identity<T>, 4>& real, VecArray<T, 4>& dual)
+		{
+			real.resize(joints.size());
+			dual.resize(joints.size());
+			for (size_t i = 0; i < size_t(joints.size()); ++i)
+			{
+				real.set(i, vector(joints[i].real.re, joints[i].real.im[0], joints[i].real.im[1], joints[i].real.im[2]));
+				dual.set(i, vector(joints[i].dual.re, joints[i].dual.im[0], joints[i].dual.im[1], joints[i].dual.im[2]));
+			}
+		}
+
+		// Dual quaternion skinning of the vertices [first, first + n), with the components of the joints in lanes. Each
+		// pass runs over the block without branches: the blends are summed an influence at a time, gathering the joints,
+		// then normalized, then applied. GCC and Clang need -fno-math-errno to vectorize the sqrt of the normalization.
+		template <class T>
+		void skin_block_lanes(const VecArray<type::identity<T>, 4>& real, const VecArray<T, 4>& dual, const SkinWeights<type::identity<T>>& skin,
+			size_t first, size_t n, const VecArray<T, 3>& positions, VecArray<T, 3>& out, const VecArray<type::identity<T>, 3>* normals, VecArray<type::identity<T>, 3>* out_normals)
+		{
+			using U = type::identity<T>;
+			const U* jr[4] = { real.lane(0), real.lane(1), real.lane(2), real.lane(3) };
+			const T* jd[4] = { dual.lane(0), dual.lane(1), dual.lane(2), dual.lane(3) };
+			// the real part of the first influence, which the others are turned towards
+			U pivot[4][skin_block];
+			const uint32_t* j0 = skin.joints.lane(0) + first;
+			for (size_t j = 0; j < n; ++j)
+			{
+				pivot[0][j] = jr[0][j0[j]];
+				pivot[1][j] = jr[1][j0[j]];
+				pivot[2][j] = jr[2][j0[j]];
+				pivot[3][j] = jr[3][j0[j]];
+			}
+			U r[4][skin_block];
+			T d[4][skin_block];
+			for (size_t c = 0; c < 4; ++c)
+			{
+				std::fill(r[c], r[c] + n, U(0));
+				std::fill(d[c], d[c] + n, T(0));
+			}
+			for (size_t k = 0; k < 4; ++k)
+			{
+				const uint32_t* jk = skin.joints.lane(k) + first;
+				const U* wk = skin.weights.lane(k) + first;
+				for (size_t j = 0; j < n; ++j)
+				{
+					const uint32_t joint = jk[j];
+					const U a0 = jr[0][joint], a1 = jr[1][joint], a2 = jr[2][joint], a3 = jr[3][joint];
+					const U w = pivot[0][j]*a0 + pivot[1][j]*a1 + pivot[2][j]*a2 + pivot[3][j]*a3 < U(0) ? -wk[j] : wk[j];
+					r[0][j] = r[0][j] + a0*w;
+					r[1][j] = r[1][j] + a1*w;
+					r[2][j] = r[2][j] + a2*w;
+					r[3][j] = r[3][j] + a3*w;
+					d[0][j] = d[0][j] + jd[0][joint]*w;
+					d[1][j] = d[1][j] + jd[1][joint]*w;
+					d[2][j] = d[2][j] + jd[2][joint]*w;
+					d[3][j] = d[3][j] + jd[3][joint]*w;
+				}
+			}
+			// the blends normalized in place, the dual parts replaced by the translations
+			for (size_t j = 0; j < n; ++j)
+			{
+				const U inv = U(1) / sqrt(r[0][j]*r[0][j] + r[1][j]*r[1][j] + r[2][j]*r[2][j] + r[3][j]*r[3][j]);
+				const U w = r[0][j]*inv, x = r[1][j]*inv, y = r[2][j]*inv, z = r[3][j]*inv;
+				const T dw = d[0][j]*inv, dx = d[1][j]*inv, dy = d[2][j]*inv, dz = d[3][j]*inv;
+				// twice the imaginary part of dual*conjugate(real)
+				d[1][j] = (w*dx - dw*x + y*dz - z*dy)*U(2);
+				d[2][j] = (w*dy - dw*y + z*dx - x*dz)*U(2);
+				d[3][j] = (w*dz - dw*z + x*dy - y*dx)*U(2);
+				r[0][j] = w;
+				r[1][j] = x;
+				r[2][j] = y;
+				r[3][j] = z;
+			}
+			// the results go to the block first, as the output lanes may be the input lanes, and checking all of them
+			// against each other for overlap would keep the loop from vectorizing
+			T o[3][skin_block];
+			const T* p[3] = { positions.lane(0) + first, positions.lane(1) + first, positions.lane(2) + first };
+			for (size_t j = 0; j < n; ++j)
+			{
+				// v + 2 im x (im x v + w v)
+				const U w = r[0][j], x = r[1][j], y = r[2][j], z = r[3][j];
+				const T vx = p[0][j], vy = p[1][j], vz = p[2][j];
+				const T cx = y*vz - z*vy + w*vx, cy = z*vx - x*vz + w*vy, cz = x*vy - y*vx + w*vz;
+				o[0][j] = vx + (y*cz - z*cy)*U(2) + d[1][j];
+				o[1][j] = vy + (z*cx - x*cz)*U(2) + d[2][j];
+				o[2][j] = vz + (x*cy - y*cx)*U(2) + d[3][j];
+			}
+			for (size_t k = 0; k < 3; ++k)
+				std::copy(o[k], o[k] + n, out.lane(k) + first);
+			if (!normals)
+				return;
+			U m[3][skin_block];
+			const U* q[3] = { normals->lane(0) + first, normals->lane(1) + first, normals->lane(2) + first };
+			for (size_t j = 0; j < n; ++j)
+			{
+				const U w = r[0][j], x = r[1][j], y = r[2][j], z = r[3][j];
+				const U vx = q[0][j], vy = q[1][j], vz = q[2][j];
+				const U cx = y*vz - z*vy + w*vx, cy = z*vx - x*vz + w*vy, cz = x*vy - y*vx + w*vz;
+				m[0][j] = vx + (y*cz - z*cy)*U(2);
+				m[1][j] = vy + (z*cx - x*cz)*U(2);
+				m[2][j] = vz + (x*cy - y*cx)*U(2);
+			}
+			for (size_t k = 0; k < 3; ++k)
+				std::copy(m[k], m[k] + n, out_normals->lane(k) + first);
+		}
+	}
+
+	// Dual quaternion skinning: moves every vertex by the blend of the transforms of the joints influencing it.
+	// The blends are normalized, so the weights of a vertex need not sum to one. 'out' may be 'positions'.
+	template <class T>
+	void skin(gsl::span<const DualQuat<T>> joints, const SkinWeights<type::identity<T>>& weights, const VecArray<T, 3>& positions, VecArray<T, 3>& out)
+	{
+		Expects(weights.size() == positions.size());
+		VecArray<type::identity<T>, 4> real;
+		VecArray<T, 4> dual;
+		details::joint_lanes(joints, real, dual);
+		out.resize(positions.size());
+		for (size_t first = 0; first < positions.size(); first += details::skin_block)
+			details::skin_block_lanes(real, dual, weights, first, std::min(details::skin_block, positions.size() - first), positions, out, nullptr, nullptr);
+	}
+	// Also rotates the normals of the vertices; 'out_normals' may be 'normals'
+	template <class T>
+	void skin(gsl::span<const DualQuat<T>> joints, const SkinWeights<type::identity<T>>& weights, const VecArray<T, 3>& positions, VecArray<T, 3>& out,
+		const VecArray<type::identity<T>, 3>& normals, VecArray<type::identity<T>, 3>& out_normals)
+	{
+		Expects(weights.size() == positions.size() && normals.size() == positions.size());
+		VecArray<type::identity<T>, 4> real;
+		VecArray<T, 4> dual;
+		details::joint_lanes(joints, real, dual);
+		out.resize(positions.size());
+		out_normals.resize(normals.size());
+		for (size_t first = 0; first < positions.size(); first += details::skin_block)
+			details::skin_block_lanes(real, dual, weights, first, std::min(details::skin_block, positions.size() - first), positions, out, &normals, &out_normals);
+	}
+}
+
+#define UVECTOR_DUALQUAT_DEFINED
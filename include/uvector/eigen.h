@@ -0,0 +1,264 @@
+#pragma once
+
+#include "matrix.h"
+#include "rotation.h"
+
+namespace uv
+{
+	// Eigendecomposition of a symmetric matrix, m = R diag(values) R^-1 with R = matrix(vectors).
+	// The eigenvectors are the columns of R and the eigenvalues come in decreasing order.
+	template <class T>
+	struct Eigen3
+	{
+		Rot3<type::identity<T>> vectors;
+		Vec3<T> values;
+	};
+
+	// Singular value decomposition, m = U diag(sigma) V^-1 with proper rotations U and V.
+	// sigma is ordered by decreasing magnitude; only the last value can be negative, which happens when det(m) < 0.
+	template <class T>
+	struct Svd3
+	{
+		Rot3<type::identity<T>> u;
+		Vec3<T> sigma;
+		Rot3<type::identity<T>> v;
+	};
+
+	namespace details
+	{
+		// The kernels below are written for a lane type L, see lane_group in matrix.h, and are free of data-dependent branches
+		template <class L>
+		struct LaneQuat
+		{
+			L re = L(scalar<L>(1));
+			L im[3] = { L(scalar<L>(0)), L(scalar<L>(0)), L(scalar<L>(0)) };
+
+			// q = q * (c + s*e_R)
+			template <size_t R>
+			void rotate(const L& c, const L& s)
+			{
+				constexpr size_t I = (R + 1) % 3, J = (R + 2) % 3;
+				const L re0 = re, r = im[R], i = im[I], j = im[J];
+				re    = re0*c - r*s;
+				im[R] = re0*s + r*c;
+				im[I] = i*c + j*s;
+				im[J] = j*c - i*s;
+			}
+
+			void normalize()
+			{
+				const L f = lane_rsqrt(re*re + im[0]*im[0] + im[1]*im[1] + im[2]*im[2]);
+				re = re*f;
+				for (auto& c : im)
+					c = c*f;
+			}
+
+			void matrix(L (&m)[3][3]) const
+			{
+				const L x = im[0], y = im[1], z = im[2], w = re;
+				const scalar<L> one = 1, two = 2;
+				m[0][0] = one - two*(y*y + z*z); m[0][1] = two*(x*y - z*w);       m[0][2] = two*(x*z + y*w);
+				m[1][0] = two*(x*y + z*w);       m[1][1] = one - two*(x*x + z*z); m[1][2] = two*(y*z - x*w);
+				m[2][0] = two*(x*z - y*w);       m[2][1] = two*(y*z + x*w);       m[2][2] = one - two*(x*x + y*y);
+			}
+		};
+
+		template <class U> static constexpr size_t jacobi_sweeps = sizeof(U) > 4 ? 8 : 5;
+
+		// Conjugates the symmetric 'a' by the rotation (c, s) in the plane (P, Q), e_P -> c*e_P + s*e_Q
+		template <size_t P, size_t Q, class L>
+		void conjugate_symmetric(L (&a)[3][3], const L& c, const L& s)
+		{
+			constexpr size_t R = 3 - P - Q;
+			const L pp = a[P][P], qq = a[Q][Q], pq = a[P][Q], pr = a[P][R], qr = a[Q][R];
+			a[P][P] = c*c*pp + scalar<L>(2)*c*s*pq + s*s*qq;
+			a[Q][Q] = s*s*pp - scalar<L>(2)*c*s*pq + c*c*qq;
+			a[P][Q] = a[Q][P] = (c*c - s*s)*pq + c*s*(qq - pp);
+			a[P][R] = a[R][P] = c*pr + s*qr;
+			a[Q][R] = a[R][Q] = c*qr - s*pr;
+		}
+
+		// One Jacobi rotation with the approximate Givens quaternion of McAdams et al., "Computing the Singular Value
+		// Decomposition of 3x3 matrices with minimal branching and elementary floating point operations" (2011).
+		// (P, Q, R) is a cyclic permutation, so the rotation is positive about e_R.
+		template <size_t P, size_t Q, class L>
+		void jacobi_rotation(L (&a)[3][3], LaneQuat<L>& v)
+		{
+			using U = scalar<L>;
+			constexpr size_t R = 3 - P - Q;
+			const U gamma = U(5.82842712474619009760), cstar = U(0.92387953251128675613), sstar = U(0.38268343236508977173);
+
+			L ch = U(2)*(a[P][P] - a[Q][Q]);
+			L sh = a[P][Q];
+			const auto exact = gamma*sh*sh < ch*ch;
+			const L w = lane_rsqrt(ch*ch + sh*sh);
+			ch = ifelse(exact, w*ch, cstar);
+			sh = ifelse(exact, w*sh, sstar);
+
+			conjugate_symmetric<P, Q>(a, ch*ch - sh*sh, U(2)*ch*sh);
+			v.template rotate<R>(ch, sh);
+		}
+
+		// Swaps eigenvalues P and Q if they are in increasing order, turning the eigenvectors by 90 degrees about e_R
+		template <size_t P, size_t Q, class L>
+		void sort_pair(L (&a)[3][3], LaneQuat<L>& v)
+		{
+			using U = scalar<L>;
+			constexpr size_t R = 3 - P - Q;
+			const auto swap = a[P][P] < a[Q][Q];
+			const L pp = a[P][P], qq = a[Q][Q];
+			a[P][P] = ifelse(swap, qq, pp);
+			a[Q][Q] = ifelse(swap, pp, qq);
+			v.template rotate<R>(ifelse(swap, L(U(0.70710678118654752440)), L(U(1))), ifelse(swap, L(U(0.70710678118654752440)), L(U(0))));
+		}
+
+		template <class L>
+		void symmetric_eigen(L (&a)[3][3], LaneQuat<L>& v)
+		{
+			for (size_t sweep = 0; sweep < jacobi_sweeps<scalar<L>>; ++sweep)
+			{
+				jacobi_rotation<0, 1>(a, v);
+				jacobi_rotation<1, 2>(a, v);
+				jacobi_rotation<2, 0>(a, v);
+			}
+			sort_pair<0, 1>(a, v);
+			sort_pair<1, 2>(a, v);
+			sort_pair<0, 1>(a, v);
+			v.normalize();
+		}
+
+		// Left-multiplies 'b' by the transposed Givens rotation in plane (P, Q) that zeroes b[Q][C], accumulating it into 'u'
+		template <size_t P, size_t Q, size_t C, class L>
+		void givens_qr(L (&b)[3][3], LaneQuat<L>& u)
+		{
+			using U = scalar<L>;
+			const L a1 = b[P][C], a2 = b[Q][C];
+			const L rho = lane_sqrt(a1*a1 + a2*a2 + std::numeric_limits<U>::min());
+			// tan(angle/2) = a2/(rho + a1) = (rho - a1)/a2; pick the form without cancellation
+			const auto positive = a1 >= U(0);
+			L ch = ifelse(positive, rho + a1, a2);
+			L sh = ifelse(positive, a2, rho - a1);
+			const L w = lane_rsqrt(ch*ch + sh*sh);
+			ch = ch*w;
+			sh = sh*w;
+			const L c = ch*ch - sh*sh, s = U(2)*ch*sh;
+			for (size_t j = 0; j < 3; ++j)
+			{
+				const L p = b[P][j], q = b[Q][j];
+				b[P][j] = c*p + s*q;
+				b[Q][j] = c*q - s*p;
+			}
+			// e_P -> c*e_P + s*e_Q turns positively about e_R only when (P, Q, R) is cyclic
+			constexpr size_t R = 3 - P - Q;
+			if constexpr ((P + 1) % 3 == Q)
+				u.template rotate<R>(ch, sh);
+			else
+				u.template rotate<R>(ch, -sh);
+		}
+
+		template <class L>
+		void svd3(const L (&m)[3][3], LaneQuat<L>& u, L (&sigma)[3], LaneQuat<L>& v)
+		{
+			L a[3][3];
+			for (size_t i = 0; i < 3; ++i)
+				for (size_t j = 0; j < 3; ++j)
+					a[i][j] = m[0][i]*m[0][j] + m[1][i]*m[1][j] + m[2][i]*m[2][j];
+			symmetric_eigen(a, v);
+
+			L r[3][3], b[3][3];
+			v.matrix(r);
+			for (size_t i = 0; i < 3; ++i)
+				for (size_t j = 0; j < 3; ++j)
+					b[i][j] = m[i][0]*r[0][j] + m[i][1]*r[1][j] + m[i][2]*r[2][j];
+
+			givens_qr<0, 1, 0>(b, u);
+			givens_qr<0, 2, 0>(b, u);
+			givens_qr<1, 2, 1>(b, u);
+			u.normalize();
+			for (size_t i = 0; i < 3; ++i)
+				sigma[i] = b[i][i];
+		}
+
+		template <class U>
+		Rot3<U> lane_rotation(const LaneQuat<U>& q)
+		{
+			return Rot3<U>::fromUnchecked(quaternion(q.re, vector(q.im[0], q.im[1], q.im[2])));
+		}
+
+		template <class U, class L>
+		void scatter(const LaneQuat<L>& q, size_t k, Quat<U>& out)
+		{
+			out = quaternion(q.re[k], vector(q.im[0][k], q.im[1][k], q.im[2][k]));
+		}
+	}
+
+	template <class T>
+	Eigen3<T> eigen(const Mat<T, 3, 3>& symmetric)
+	{
+		using U = type::identity<T>;
+		U a[3][3];
+		for (size_t i = 0; i < 3; ++i)
+			for (size_t j = 0; j < 3; ++j)
+				a[i][j] = rows(symmetric)[i][j] / T(1);
+		details::LaneQuat<U> v;
+		details::symmetric_eigen(a, v);
+		return { details::lane_rotation(v), vector(a[0][0], a[1][1], a[2][2]) * T(1) };
+	}
+
+	template <class T>
+	Svd3<T> svd(const Mat<T, 3, 3>& m)
+	{
+		using U = type::identity<T>;
+		U a[3][3], sigma[3];
+		for (size_t i = 0; i < 3; ++i)
+			for (size_t j = 0; j < 3; ++j)
+				a[i][j] = rows(m)[i][j] / T(1);
+		details::LaneQuat<U> u, v;
+		details::svd3(a, u, sigma, v);
+		return { details::lane_rotation(u), vector(sigma[0], sigma[1], sigma[2]) * T(1), details::lane_rotation(v) };
+	}
+
+	// Batched variants, decomposing a lane group of matrices at a time; results are unit quaternions
+	template <class T>
+	void eigen(gsl::span<const Mat<T, 3, 3>> symmetric, gsl::span<Quat<type::identity<T>>> vectors, gsl::span<Vec3<T>> values)
+	{
+		using U = type::identity<T>;
+		using L = Vec<U, details::lane_group<U>>;
+		Expects(vectors.size() == symmetric.size() && values.size() == symmetric.size());
+		for (size_t first = 0; first < size_t(symmetric.size()); first += dim<L>)
+		{
+			L a[3][3];
+			const size_t n = details::gather_lanes(symmetric, first, a);
+			details::LaneQuat<L> v;
+			details::symmetric_eigen(a, v);
+			for (size_t k = 0; k < n; ++k)
+			{
+				details::scatter(v, k, vectors[first + k]);
+				values[first + k] = vector(a[0][0][k], a[1][1][k], a[2][2][k]) * T(1);
+			}
+		}
+	}
+
+	template <class T>
+	void svd(gsl::span<const Mat<T, 3, 3>> m, gsl::span<Quat<type::identity<T>>> u, gsl::span<Vec3<T>> sigma, gsl::span<Quat<type::identity<T>>> v)
+	{
+		using U = type::identity<T>;
+		using L = Vec<U, details::lane_group<U>>;
+		Expects(u.size() == m.size() && sigma.size() == m.size() && v.size() == m.size());
+		for (size_t first = 0; first < size_t(m.size()); first += dim<L>)
+		{
+			L a[3][3], s[3];
+			const size_t n = details::gather_lanes(m, first, a);
+			details::LaneQuat<L> lu, lv;
+			details::svd3(a, lu, s, lv);
+			for (size_t k = 0; k < n; ++k)
+			{
+				details::scatter(lu, k, u[first + k]);
+				details::scatter(lv, k, v[first + k]);
+				sigma[first + k] = vector(s[0][k], s[1][k], s[2][k]) * T(1);
+			}
+		}
+	}
+}
+
+#define UVECTOR_EIGEN_DEFINED
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "bounds.h"
+#include "matrix.h"
+#include "plane.h"
+
+namespace uv
+{
+	// Six planes facing inwards, in the order left, right, bottom, top, near, far
+	template <class T>
+	struct Frustum
+	{
+		using U = type::identity<T>;
+
+		Plane<T> planes[6];
+
+		Frustum() = default;
+		// The planes of the OpenGL clip volume -w <= x, y, z <= w of 'clip', eg. projection*view acting on column vectors
+		explicit Frustum(const Mat<U, 4, 4>& clip)
+		{
+			const auto& r = rows(clip);
+			for (size_t k = 0; k < 3; ++k)
+			{
+				const Vec<U, 4> lower = r[3] + r[k], upper = r[3] - r[k];
+				planes[2*k]     = Plane<T>::fromCoefficients(vector(lower[0], lower[1], lower[2]), lower[3] * T(1));
+				planes[2*k + 1] = Plane<T>::fromCoefficients(vector(upper[0], upper[1], upper[2]), upper[3] * T(1));
+			}
+		}
+	};
+
+	using Frustumf = Frustum<float>;
+	using Frustumd = Frustum<double>;
+
+	// True when the box is entirely outside one of the planes. Like all plane-by-plane tests this is conservative,
+	// keeping some boxes near the edges of the frustum that are outside it.
+	template <class T>
+	bool culled(const Frustum<T>& f, const Bounds3<T>& box)
+	{
+		const auto c = mean(box);
+		const auto e = span(box) * type::identity<T>(0.5);
+		for (const auto& p : f.planes)
+		{
+			// the distance of the corner furthest along the normal
+			T d = p.offset;
+			for (size_t k = 0; k < 3; ++k)
+				d = d + p.normal[k] * c[k] + std::abs(p.normal[k]) * e[k];
+			if (!(d >= T(0)))
+				return true;
+		}
+		return false;
+	}
+
+	// Writes the index of every box that is not culled to 'visible', in increasing order, returning how many there are.
+	// Boxes are converted to center and extent form a block at a time, so the plane tests run over contiguous lanes,
+	// keeping the smallest distance of the furthest corner over all planes.
+	template <class T>
+	size_t cull(const Frustum<T>& f, gsl::span<const Bounds3<T>> boxes, gsl::span<uint32_t> visible)
+	{
+		using U = type::identity<T>;
+		Expects(size_t(visible.size()) >= size_t(boxes.size()));
+		constexpr size_t block = 64;
+		T c[3][block], e[3][block], margin[block];
+		uint32_t* out = visible.data();
+		size_t count = 0;
+		for (size_t first = 0; first < size_t(boxes.size()); first += block)
+		{
+			const size_t n = std::min(block, size_t(boxes.size()) - first);
+			for (size_t i = 0; i < n; ++i)
+			{
+				const auto& box = boxes[first + i];
+				const auto center = mean(box);
+				const auto extent = span(box) * U(0.5);
+				for (size_t k = 0; k < 3; ++k)
+				{
+					c[k][i] = center[k];
+					e[k][i] = extent[k];
+				}
+				// empty boxes have NaN centers, which the minimum below would skip
+				margin[i] = any(max(box) < min(box)) ? T(-1) : std::numeric_limits<T>::infinity();
+			}
+			for (const auto& p : f.planes)
+			{
+				const U n0 = p.normal[0], n1 = p.normal[1], n2 = p.normal[2];
+				const U a0 = std::abs(n0), a1 = std::abs(n1), a2 = std::abs(n2);
+				for (size_t i = 0; i < n; ++i)
+				{
+					const T d = p.offset + n0*c[0][i] + n1*c[1][i] + n2*c[2][i] + a0*e[0][i] + a1*e[1][i] + a2*e[2][i];
+					margin[i] = d < margin[i] ? d : margin[i];
+				}
+			}
+			// written unconditionally and kept by advancing, so compaction does not branch on visibility
+			for (size_t i = 0; i < n; ++i)
+			{
+				out[count] = uint32_t(first + i);
+				count += margin[i] >= T(0);
+			}
+		}
+		return count;
+	}
+}
+
+#define UVECTOR_FRUSTUM_DEFINED
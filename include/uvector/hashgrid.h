@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "point.h"
+
+namespace uv
+{
+	// Uniform grid over a span of points, storing only the occupied cells. Cells are found through an open addressing
+	// table keyed by the integer coordinates of the cell, and the points are copied in cell order, so each cell is
+	// a contiguous range. Rebuilding reuses all the storage, which suits particles that move every step.
+	template <class T, size_t N>
+	class HashGrid
+	{
+	public:
+		using U = type::identity<T>;
+		using M = type::mul<T>;
+		using Key = Vec<int32_t, N>;
+
+		static constexpr uint32_t no_cell = std::numeric_limits<uint32_t>::max();
+
+	private:
+		struct Slot
+		{
+			Key key;
+			uint32_t cell;
+		};
+
+		T _cell_size;
+		std::vector<Slot> _slots; // power of two sized, at most half full, probed linearly
+		std::vector<uint32_t> _starts; // the points of cell c are [_starts[c], _starts[c + 1])
+		std::vector<uint32_t> _indices; // position in the span given to build() of each point in cell order
+		std::vector<Point<T, N>> _points; // the points in cell order
+		std::vector<uint32_t> _cells; // cell of each point in the order given to build()
+
+		// The 3^N cells around a point
+		static constexpr size_t _around()
+		{
+			size_t n = 1;
+			for (size_t k = 0; k < N; ++k)
+				n *= 3;
+			return n;
+		}
+
+		size_t _slot(const Key& key) const
+		{
+			const size_t mask = _slots.size() - 1;
+			size_t s = std::hash<Key>()(key) & mask;
+			while (_slots[s].cell != no_cell && !all(_slots[s].key == key))
+				s = (s + 1) & mask;
+			return s;
+		}
+
+	public:
+		explicit HashGrid(T cell_size) : _cell_size(cell_size) { Expects(cell_size > T(0)); }
+		HashGrid(T cell_size, gsl::span<const Point<T, N>> points) : HashGrid(cell_size) { build(points); }
+
+		// Counting sort of the points into their cells: one pass numbers the cells in the order their first points
+		// appear and counts their points, the prefix sum of the counts gives the ranges, and a second pass scatters
+		// the points into them. Points sorted along a curve beforehand, eg. by morton_sort, give neighbouring cells
+		// neighbouring ranges.
+		void build(gsl::span<const Point<T, N>> points)
+		{
+			const size_t n = points.size();
+			Expects(n < no_cell);
+			size_t capacity = 16;
+			while (capacity < 2*n)
+				capacity *= 2;
+			_slots.assign(capacity, { Key(0), no_cell });
+			_starts.assign(1, 0);
+			_cells.resize(n);
+			for (size_t i = 0; i < n; ++i)
+			{
+				const Key key = this->key(points[i]);
+				Slot& slot = _slots[_slot(key)];
+				if (slot.cell == no_cell)
+				{
+					slot = { key, uint32_t(_starts.size() - 1) };
+					_starts.push_back(0);
+				}
+				_cells[i] = slot.cell;
+				++_starts[slot.cell + 1];
+			}
+			for (size_t c = 1; c < _starts.size(); ++c)
+				_starts[c] += _starts[c - 1];
+
+			_indices.resize(n);
+			_points.resize(n);
+			std::vector<uint32_t> next(_starts.begin(), _starts.end() - 1);
+			for (size_t i = 0; i < n; ++i)
+			{
+				const uint32_t j = next[_cells[i]]++;
+				_indices[j] = uint32_t(i);
+				_points[j] = points[i];
+			}
+		}
+
+		T cell_size() const { return _cell_size; }
+		size_t size() const { return _points.size(); }
+		// The number of occupied cells
+		size_t cells() const { return _starts.size() - 1; }
+
+		// The integer coordinates of the cell containing p, rounded down along every axis
+		Key key(const Point<T, N>& p) const
+		{
+			Key k;
+			for (size_t i = 0; i < N; ++i)
+			{
+				const U x = p.v[i] / _cell_size;
+				const int32_t t = int32_t(x);
+				k[i] = t - int32_t(x < U(t));
+			}
+			return k;
+		}
+
+		// The occupied cell with these coordinates, or no_cell
+		uint32_t cell(const Key& key) const { return _slots.empty() ? no_cell : _slots[_slot(key)].cell; }
+		uint32_t cell(const Point<T, N>& p) const { return cell(key(p)); }
+		// The cell of the i-th point given to build()
+		uint32_t cell_of(size_t i) const { return _cells[i]; }
+
+		// The points of a cell, and their positions in the span given to build()
+		gsl::span<const Point<T, N>> points(uint32_t cell) const { return { _points.data() + _starts[cell], size_t(_starts[cell + 1] - _starts[cell]) }; }
+		gsl::span<const uint32_t> indices(uint32_t cell) const { return { _indices.data() + _starts[cell], size_t(_starts[cell + 1] - _starts[cell]) }; }
+
+		// Calls f(index, distance2) for every point within 'radius' of q, which may not exceed the cell size, so that
+		// only the 3^N cells around q are visited. All the cells are looked up before any is scanned, so the table
+		// reads, which mostly miss the cache, overlap instead of waiting for the scans between them.
+		template <class F>
+		void neighbors(const Point<T, N>& q, T radius, F&& f) const
+		{
+			Expects(!(_cell_size < radius));
+			if (_slots.empty())
+				return;
+			const M r2 = radius*radius;
+			const Key center = key(q);
+			uint32_t cells[_around()];
+			Key offset(-1);
+			for (size_t j = 0; j < _around(); ++j)
+			{
+				cells[j] = _slots[_slot(center + offset)].cell;
+				// advance the offset like an odometer over {-1, 0, 1}^N, axis 0 first
+				for (size_t k = 0; k < N && ++offset[k] == 2; ++k)
+					offset[k] = -1;
+			}
+			for (size_t j = 0; j < _around(); ++j)
+			{
+				if (cells[j] == no_cell)
+					continue;
+				const uint32_t first = _starts[cells[j]], last = _starts[cells[j] + 1];
+				for (uint32_t i = first; i < last; ++i)
+				{
+					const M d2 = square(_points[i] - q);
+					if (!(r2 < d2))
+						f(size_t(_indices[i]), d2);
+				}
+			}
+		}
+		template <class F>
+		void neighbors(const Point<T, N>& q, F&& f) const { neighbors(q, _cell_size, f); }
+	};
+
+	template <class T> using HashGrid2 = HashGrid<T, 2>;
+	template <class T> using HashGrid3 = HashGrid<T, 3>;
+}
+
+#define UVECTOR_HASHGRID_DEFINED
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "matrix.h"
+#include "reduce.h"
+#include "transform.h"
+
+namespace uv
+{
+	// Parent-child hierarchy of rigid transforms, such as a scene graph or a skeleton, keeping the world transform of
+	// every node, the world transform of its parent times its local transform. Nodes are stored flat in the order they
+	// are added, which puts parents first, and the world transforms and their matrices are kept in that order, ready
+	// to upload. Setting a local transform only marks the node; update() then recomputes the marked nodes and their
+	// descendants, and nothing else. The nodes are also listed by depth, as the nodes of a level depend only on the
+	// levels above and can be composed in parallel.
+	template <class T>
+	class TransformHierarchy
+	{
+	public:
+		using U = type::identity<T>;
+
+		static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+		// Levels with fewer changed nodes are composed on the calling thread, as starting threads would cost more, and
+		// hierarchies without a level this wide are updated on it
+		static constexpr size_t parallel_level = 1 << 14;
+
+	private:
+		static constexpr size_t _chunk = 1 << 12;
+
+		std::vector<uint32_t> _parents;
+		std::vector<uint32_t> _depths;
+		std::vector<Trans3<T>> _local;
+		std::vector<Trans3<T>> _world;
+		std::vector<Mat<U, 4, 4>> _matrices; // homogeneous(_world[i]), when cached
+		std::vector<std::vector<uint32_t>> _levels; // the nodes at each depth, in increasing order
+		std::vector<uint8_t> _dirty; // local transform set since the last update(), or world transform changed during it
+		std::vector<uint32_t> _changed; // the nodes of the level being updated that have to be recomputed
+		size_t _widest = 0; // the number of nodes in the largest level
+		size_t _first_dirty = 0; // the first marked node, or size() when there is none
+		size_t _shallowest_dirty = 0; // the depth of the shallowest marked node, or levels() when there is none
+		bool _cache_matrices;
+
+		void _mark(uint32_t node)
+		{
+			_dirty[node] = 1;
+			_first_dirty = std::min<size_t>(_first_dirty, node);
+			_shallowest_dirty = std::min<size_t>(_shallowest_dirty, _depths[node]);
+		}
+
+		// The world transforms, and matrices, of _changed[first, last) at depth 'depth'
+		void _compose(size_t depth, size_t first, size_t last)
+		{
+			if (depth == 0)
+				for (size_t k = first; k < last; ++k)
+					_world[_changed[k]] = _local[_changed[k]];
+			else
+				for (size_t k = first; k < last; ++k)
+				{
+					const uint32_t i = _changed[k];
+					_world[i] = _world[_parents[i]] * _local[i];
+				}
+			if (_cache_matrices)
+				for (size_t k = first; k < last; ++k)
+					_matrices[_changed[k]] = homogeneous(_world[_changed[k]]);
+		}
+
+	public:
+		// With 'matrices', update() also keeps homogeneous() of every world transform
+		explicit TransformHierarchy(bool matrices = false) : _cache_matrices(matrices) { }
+
+		// Adds a node below 'parent', which must already be in the hierarchy, or a root, returning its index
+		uint32_t add(const Trans3<T>& local, uint32_t parent = none)
+		{
+			Expects(parent == none || parent < size());
+			Expects(size() < none);
+			const uint32_t node = uint32_t(size());
+			const uint32_t depth = parent == none ? 0 : _depths[parent] + 1;
+			_parents.push_back(parent);
+			_depths.push_back(depth);
+			_local.push_back(local);
+			_world.push_back(parent == none ? local : _world[parent] * local);
+			if (_cache_matrices)
+				_matrices.push_back(homogeneous(_world.back()));
+			if (_levels.size() <= depth)
+				_levels.resize(depth + 1);
+			_levels[depth].push_back(node);
+			_widest = std::max(_widest, _levels[depth].size());
+			_dirty.push_back(0);
+			// the parent may be waiting for an update, which its world transform above did not see
+			if (parent != none && _dirty[parent])
+				_mark(node);
+			return node;
+		}
+
+		size_t size() const { return _parents.size(); }
+		// The number of depth levels, one more than the depth of the deepest node
+		size_t levels() const { return _levels.size(); }
+		uint32_t parent(uint32_t node) const { return _parents[node]; }
+		uint32_t depth(uint32_t node) const { return _depths[node]; }
+
+		const Trans3<T>& local(uint32_t node) const { return _local[node]; }
+		void set_local(uint32_t node, const Trans3<T>& local)
+		{
+			_local[node] = local;
+			_mark(node);
+		}
+
+		// As of the last update()
+		const Trans3<T>& world(uint32_t node) const { return _world[node]; }
+		const std::vector<Trans3<T>>& world() const { return _world; }
+		const std::vector<Mat<U, 4, 4>>& matrices() const { Expects(_cache_matrices); return _matrices; }
+
+		// Recomputes the world transforms of the nodes whose local transforms were set, and of all their descendants,
+		// returning how many there were. On one thread the nodes are visited in order from the first one set, reading
+		// the arrays forward. On more, given by 'threads' with zero meaning one per hardware thread, the hierarchy is
+		// instead updated one depth level at a time from the shallowest one set, listing the changed nodes of a level
+		// and then composing them in parallel, when some level is wide enough to be worth it.
+		size_t update(size_t threads = 0)
+		{
+			if (threads == 0)
+				threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+			size_t count = 0;
+			if (threads == 1 || _widest < parallel_level)
+				for (size_t i = _first_dirty; i < size(); ++i)
+				{
+					const uint32_t p = _parents[i];
+					const uint8_t dirty = _dirty[i] | (p == none ? uint8_t(0) : _dirty[p]);
+					_dirty[i] = dirty;
+					if (dirty)
+					{
+						_world[i] = p == none ? _local[i] : _world[p] * _local[i];
+						if (_cache_matrices)
+							_matrices[i] = homogeneous(_world[i]);
+						++count;
+					}
+				}
+			else
+				for (size_t d = _shallowest_dirty; d < _levels.size(); ++d)
+				{
+					const auto& level = _levels[d];
+					_changed.resize(level.size());
+					size_t n = 0;
+					for (const uint32_t i : level)
+					{
+						const uint8_t dirty = _dirty[i] | (d > 0 ? _dirty[_parents[i]] : uint8_t(0));
+						_dirty[i] = dirty;
+						_changed[n] = i;
+						n += dirty;
+					}
+					details::parallel_for((n + _chunk - 1) / _chunk, n < parallel_level ? 1 : threads, [&](size_t c) { _compose(d, c*_chunk, std::min(n, (c + 1)*_chunk)); });
+					count += n;
+				}
+			if (_first_dirty < size())
+				std::fill(_dirty.begin() + _first_dirty, _dirty.end(), uint8_t(0));
+			_first_dirty = size();
+			_shallowest_dirty = _levels.size();
+			return count;
+		}
+	};
+
+	using TransformHierarchyf = TransformHierarchy<float>;
+	using TransformHierarchyd = TransformHierarchy<double>;
+}
+
+#define UVECTOR_HIERARCHY_DEFINED
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "reduce.h"
+
+namespace uv
+{
+	// k-d tree over a span of points, which it reorders in place so that every leaf is a contiguous range.
+	// The tree is implicit and balanced: node i has children 2i+1 and 2i+2, and splits its range at the middle,
+	// so only the split planes are stored. The points must outlive the tree and not move while it is in use.
+	template <class T, size_t N>
+	class KdTree
+	{
+	public:
+		using M = type::mul<T>;
+
+		struct Neighbor
+		{
+			uint32_t index; // position of the point before the tree reordered them
+			M distance2;
+		};
+
+		static constexpr size_t bucket_size = 16;
+
+	private:
+		struct Node
+		{
+			T split;
+			uint32_t axis;
+		};
+
+		gsl::span<const Point<T, N>> _points;
+		std::vector<Node> _nodes;
+		std::vector<uint32_t> _indices;
+		size_t _levels = 0;
+
+		struct Range { size_t node, first, last, depth; };
+
+		// Chooses the axis of largest extent of order[first, last) and moves the median along it to the middle
+		void _split(std::vector<uint32_t>& order, const Range& r)
+		{
+			Vec<Bounds<T>, N> box;
+			for (size_t k = 0; k < N; ++k)
+				box[k] = empty;
+			for (size_t i = r.first; i < r.last; ++i)
+				for (size_t k = 0; k < N; ++k)
+				{
+					const T x = _points[order[i]].v[k];
+					box[k].min = x < box[k].min ? x : box[k].min;
+					box[k].max = box[k].max < x ? x : box[k].max;
+				}
+			const auto extent = span(box);
+			uint32_t axis = 0;
+			for (uint32_t k = 1; k < N; ++k)
+				axis = extent[axis] < extent[k] ? k : axis;
+			const size_t mid = r.first + (r.last - r.first)/2;
+			std::nth_element(order.begin() + r.first, order.begin() + mid, order.begin() + r.last,
+				[&](uint32_t a, uint32_t b) { return _points[a].v[axis] < _points[b].v[axis]; });
+			_nodes[r.node] = { _points[order[mid]].v[axis], axis };
+		}
+
+		void _build(std::vector<uint32_t>& order, const Range& r)
+		{
+			if (r.depth == _levels)
+				return;
+			_split(order, r);
+			const size_t mid = r.first + (r.last - r.first)/2;
+			_build(order, { 2*r.node + 1, r.first, mid, r.depth + 1 });
+			_build(order, { 2*r.node + 2, mid, r.last, r.depth + 1 });
+		}
+
+		// Squared distances from q to the points of a leaf, a loop over contiguous points that vectorizes
+		void _distances(const Range& leaf, const Point<T, N>& q, M* d2) const
+		{
+			const Point<T, N>* p = _points.data() + leaf.first;
+			const size_t n = leaf.last - leaf.first;
+			for (size_t i = 0; i < n; ++i)
+				d2[i] = square(p[i] - q);
+		}
+
+		// Visits the leaves nearest first, skipping subtrees whose split plane is further away than 'bound()'
+		template <class B, class F>
+		void _search(const Point<T, N>& q, B&& bound, F&& leaf) const
+		{
+			struct Entry { Range range; M d2; };
+			Entry stack[64];
+			size_t top = 0;
+			stack[top++] = { { 0, 0, size_t(_points.size()), 0 }, M(0) };
+			while (top > 0)
+			{
+				const Entry e = stack[--top];
+				if (bound() < e.d2)
+					continue;
+				const Range& r = e.range;
+				if (r.depth == _levels)
+				{
+					leaf(r);
+					continue;
+				}
+				const Node& node = _nodes[r.node];
+				const size_t mid = r.first + (r.last - r.first)/2;
+				const T diff = q.v[node.axis] - node.split;
+				const M plane = diff*diff;
+				const Range left = { 2*r.node + 1, r.first, mid, r.depth + 1 }, right = { 2*r.node + 2, mid, r.last, r.depth + 1 };
+				const bool below = diff < T(0);
+				stack[top++] = { below ? right : left, plane < e.d2 ? e.d2 : plane };
+				stack[top++] = { below ? left : right, e.d2 };
+			}
+		}
+
+	public:
+		KdTree() = default;
+		explicit KdTree(gsl::span<Point<T, N>> points) { build(points); }
+
+		void build(gsl::span<Point<T, N>> points)
+		{
+			const size_t n = points.size();
+			_points = gsl::span<const Point<T, N>>(points.data(), points.size());
+			_levels = 0;
+			while ((n >> _levels) > bucket_size)
+				++_levels;
+			_nodes.resize((size_t(1) << _levels) - 1);
+			std::vector<uint32_t> order(n);
+			for (size_t i = 0; i < n; ++i)
+				order[i] = uint32_t(i);
+
+			// the top levels one by one, then the subtrees below them on the threads
+			const size_t parallel_depth = std::min<size_t>(_levels, 6);
+			std::vector<Range> level = { { 0, 0, n, 0 } };
+			while (!level.empty() && level.front().depth < parallel_depth)
+			{
+				std::vector<Range> next;
+				for (const auto& r : level)
+				{
+					_split(order, r);
+					const size_t mid = r.first + (r.last - r.first)/2;
+					next.push_back({ 2*r.node + 1, r.first, mid, r.depth + 1 });
+					next.push_back({ 2*r.node + 2, mid, r.last, r.depth + 1 });
+				}
+				level.swap(next);
+			}
+			details::parallel_for(level.size(), 0, [&](size_t i) { _build(order, level[i]); });
+
+			details::permute(points, order, 0);
+			_indices = std::move(order);
+		}
+
+		size_t size() const { return _points.size(); }
+		// The original position of the point now at position i
+		uint32_t index(size_t i) const { return _indices[i]; }
+
+		// The result.size() points nearest to q, nearest first; returns how many were found, which is less only if the tree is smaller
+		size_t nearest(const Point<T, N>& q, gsl::span<Neighbor> result) const
+		{
+			const size_t k = std::min(size_t(result.size()), size());
+			if (k == 0)
+				return 0;
+			Neighbor* heap = result.data();
+			size_t count = 0;
+			const auto further = [](const Neighbor& a, const Neighbor& b) { return a.distance2 < b.distance2; };
+			_search(q, [&] { return count < k ? std::numeric_limits<M>::infinity() : heap[0].distance2; }, [&](const Range& leaf)
+			{
+				M d2[2*bucket_size];
+				_distances(leaf, q, d2);
+				for (size_t i = 0; i < leaf.last - leaf.first; ++i)
+				{
+					if (count < k)
+					{
+						heap[count++] = { _indices[leaf.first + i], d2[i] };
+						std::push_heap(heap, heap + count, further);
+					}
+					else if (d2[i] < heap[0].distance2)
+					{
+						std::pop_heap(heap, heap + k, further);
+						heap[k - 1] = { _indices[leaf.first + i], d2[i] };
+						std::push_heap(heap, heap + k, further);
+					}
+				}
+			});
+			std::sort_heap(heap, heap + k, further);
+			return k;
+		}
+
+		// Calls f(index, distance2) for every point within 'radius' of q, in no particular order
+		template <class F>
+		void radius(const Point<T, N>& q, T r, F&& f) const
+		{
+			const M r2 = r*r;
+			_search(q, [&] { return r2; }, [&](const Range& leaf)
+			{
+				M d2[2*bucket_size];
+				_distances(leaf, q, d2);
+				for (size_t i = 0; i < leaf.last - leaf.first; ++i)
+					if (!(r2 < d2[i]))
+						f(size_t(_indices[leaf.first + i]), d2[i]);
+			});
+		}
+
+		// The k nearest neighbors of every query, written to result[i*k, (i + 1)*k) and found on all hardware threads
+		void nearest(gsl::span<const Point<T, N>> queries, size_t k, gsl::span<Neighbor> result) const
+		{
+			Expects(size_t(result.size()) == size_t(queries.size()) * k && k <= size());
+			constexpr size_t chunk = 256;
+			details::parallel_for((size_t(queries.size()) + chunk - 1) / chunk, 0, [&](size_t c)
+			{
+				for (size_t i = c*chunk; i < std::min(size_t(queries.size()), (c + 1)*chunk); ++i)
+					nearest(queries[i], result.subspan(i*k, k));
+			});
+		}
+	};
+
+	template <class T> using KdTree2 = KdTree<T, 2>;
+	template <class T> using KdTree3 = KdTree<T, 3>;
+}
+
+#define UVECTOR_KDTREE_DEFINED
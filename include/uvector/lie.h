@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+
+#include "matrix.h"
+#include "transform.h"
+
+namespace uv
+{
+	// A tangent vector of rigid motions: the translation 'rho', in the unit of T, and the rotation vector 'phi', the
+	// axis scaled by the angle. exp() turns it into the Trans3 moving along the screw it describes for unit time.
+	template <class T>
+	struct Twist
+	{
+		Vec3<T> rho;
+		Vec3<type::identity<T>> phi;
+	};
+
+	namespace details
+	{
+		// Below this squared angle, the coefficients of the exponential maps are taken from their Taylor series, which
+		// are then exact to rounding, instead of divided by the angle
+		template <class U>
+		U small_angle2() { return std::sqrt(std::numeric_limits<U>::epsilon()); }
+
+		// The coefficients of [phi]x and [phi]x^2 in the left Jacobian of SO(3), (1 - cos t)/t^2 and (t - sin t)/t^3,
+		// and of [phi]x^2 in its inverse, 1/t^2 - (1 + cos t)/(2t sin t), for the angle t. The closed forms take the sine
+		// and cosine of t/2, which exp and log have at hand. The first is evaluated as 2sin^2(t/2)/t^2, which does not
+		// cancel; the others do, but they multiply a term of size t^2, so the error they add stays at the rounding of 1.
+		template <class U>
+		struct So3Coefficients
+		{
+			U a, b, c;
+
+			static So3Coefficients series(U theta2) { return { U(0.5) - theta2/U(24), U(1)/U(6) - theta2/U(120), U(1)/U(12) + theta2/U(720) }; }
+			static So3Coefficients closed(U theta, U s, U co)
+			{
+				const U theta2 = theta*theta;
+				return { U(2)*s*s / theta2, (theta - U(2)*s*co) / (theta2*theta), U(1)/theta2 - co/(U(2)*theta*s) };
+			}
+			static So3Coefficients of(U theta2)
+			{
+				if (theta2 < small_angle2<U>())
+					return series(theta2);
+				const U theta = sqrt(theta2);
+				return closed(theta, sin(theta/2), cos(theta/2));
+			}
+		};
+
+		// exp(phi), and the coefficients of its Jacobians if k is given
+		template <class U>
+		Rot3<U> so3_exp(const Vec3<U>& phi, So3Coefficients<U>* k)
+		{
+			const U theta2 = square(phi);
+			if (theta2 < small_angle2<U>())
+			{
+				if (k)
+					*k = So3Coefficients<U>::series(theta2);
+				return Rot3<U>::fromUnchecked(quaternion(U(1) - theta2/U(8), phi * (U(0.5) - theta2/U(48))));
+			}
+			const U theta = sqrt(theta2);
+			const U s = sin(theta/2), co = cos(theta/2);
+			if (k)
+				*k = So3Coefficients<U>::closed(theta, s, co);
+			return Rot3<U>::fromUnchecked(quaternion(co, phi * (s / theta)));
+		}
+
+		// log(r), and the coefficients of the Jacobians of the result if k is given
+		template <class U>
+		Vec3<U> so3_log(const Rot3<U>& r, So3Coefficients<U>* k)
+		{
+			const Quat<U>& q = quaternion(r);
+			// q and -q are the same rotation; the one with re >= 0 has the shorter angle
+			const U w = q.re < U(0) ? -q.re : q.re;
+			const Vec3<U> v = q.re < U(0) ? -q.im : q.im;
+			const U n2 = square(v);
+			if (n2 < small_angle2<U>())
+			{
+				const Vec3<U> phi = v * (U(2)/w - U(2)*n2/(U(3)*w*w*w));
+				if (k)
+					*k = So3Coefficients<U>::series(square(phi));
+				return phi;
+			}
+			// half the angle, from whichever of its sine and cosine is smaller, where the inverse is well conditioned
+			const U n = sqrt(n2);
+			const U half = n < w ? std::asin(n) : std::acos(w);
+			if (k)
+				*k = So3Coefficients<U>::closed(U(2)*half, n, w);
+			return v * (U(2)*half / n);
+		}
+
+		// I + ka [phi]x + kb [phi]x^2, using [phi]x^2 = phi phi' - |phi|^2 I
+		template <class U>
+		Mat<U, 3, 3> so3_jacobian(const Vec3<U>& phi, U ka, U kb)
+		{
+			const U x = phi[0], y = phi[1], z = phi[2];
+			const U d = U(1) - kb*square(phi);
+			return rows(
+				vector(d + kb*x*x, kb*x*y - ka*z, kb*x*z + ka*y),
+				vector(kb*y*x + ka*z, d + kb*y*y, kb*y*z - ka*x),
+				vector(kb*z*x - ka*y, kb*z*y + ka*x, d + kb*z*z));
+		}
+	}
+
+	// The rotation by the angle |phi| about phi, the exponential map of SO(3). Unlike rotation(phi), which goes through
+	// decompose() and Rot2::about(), it takes one sqrt and one sincos, and none near zero.
+	template <class U>
+	Rot3<U> exp(const Vec3<U>& phi) { return details::so3_exp(phi, static_cast<details::So3Coefficients<U>*>(nullptr)); }
+
+	// The rotation vector of r, with an angle in [0, pi], the logarithm of SO(3). Unlike vector(r), it does not lose
+	// precision near pi, and it takes no square root or division by the angle near zero.
+	template <class U>
+	Vec3<U> log(const Rot3<U>& r) { return details::so3_log(r, static_cast<details::So3Coefficients<U>*>(nullptr)); }
+
+	// The motion along the screw described by the twist, the exponential map of SE(3): the rotation exp(phi), and the
+	// translation of rho through the left Jacobian of phi
+	template <class T>
+	Trans3<T> exp(const Twist<T>& xi)
+	{
+		using U = type::identity<T>;
+		details::So3Coefficients<U> k;
+		const Rot3<U> r = details::so3_exp(xi.phi, &k);
+		const Vec3<T> c = cross(xi.phi, xi.rho);
+		return { r, xi.rho + c*k.a + cross(xi.phi, c)*k.b };
+	}
+
+	// The twist of a rigid motion, the logarithm of SE(3)
+	template <class T>
+	Twist<T> log(const Trans3<T>& tf)
+	{
+		using U = type::identity<T>;
+		details::So3Coefficients<U> k;
+		const Vec3<U> phi = details::so3_log(tf.r, &k);
+		const Vec3<T> c = cross(phi, tf.t);
+		return { tf.t - c*U(0.5) + cross(phi, c)*k.c, phi };
+	}
+
+	// The Jacobians of exp(phi) on SO(3): exp(phi + d) = exp(left_jacobian(phi)*d)*exp(phi) = exp(phi)*exp(right_jacobian(phi)*d)
+	// to first order in d, and their inverses, which map a small rotation back to the change in phi. Gauss-Newton
+	// steps on rotations use these instead of the derivatives of rotation matrices.
+	template <class U>
+	Mat<U, 3, 3> left_jacobian(const Vec3<U>& phi) { const auto k = details::So3Coefficients<U>::of(square(phi)); return details::so3_jacobian(phi, k.a, k.b); }
+	template <class U>
+	Mat<U, 3, 3> right_jacobian(const Vec3<U>& phi) { const auto k = details::So3Coefficients<U>::of(square(phi)); return details::so3_jacobian(phi, -k.a, k.b); }
+	template <class U>
+	Mat<U, 3, 3> left_jacobian_inverse(const Vec3<U>& phi) { const auto k = details::So3Coefficients<U>::of(square(phi)); return details::so3_jacobian(phi, U(-0.5), k.c); }
+	template <class U>
+	Mat<U, 3, 3> right_jacobian_inverse(const Vec3<U>& phi) { const auto k = details::So3Coefficients<U>::of(square(phi)); return details::so3_jacobian(phi, U(0.5), k.c); }
+
+	// The maps over spans, writing element i of 'out' from element i of 'in'
+	template <class U>
+	void exp(gsl::span<const Vec3<U>> in, gsl::span<Rot3<U>> out)
+	{
+		Expects(in.size() == out.size());
+		for (size_t i = 0; i < size_t(in.size()); ++i)
+			out[i] = exp(in[i]);
+	}
+	template <class U>
+	void log(gsl::span<const Rot3<U>> in, gsl::span<Vec3<U>> out)
+	{
+		Expects(in.size() == out.size());
+		for (size_t i = 0; i < size_t(in.size()); ++i)
+			out[i] = log(in[i]);
+	}
+	template <class T>
+	void exp(gsl::span<const Twist<T>> in, gsl::span<Trans3<T>> out)
+	{
+		Expects(in.size() == out.size());
+		for (size_t i = 0; i < size_t(in.size()); ++i)
+			out[i] = exp(in[i]);
+	}
+	template <class T>
+	void log(gsl::span<const Trans3<T>> in, gsl::span<Twist<T>> out)
+	{
+		Expects(in.size() == out.size());
+		for (size_t i = 0; i < size_t(in.size()); ++i)
+			out[i] = log(in[i]);
+	}
+}
+
+#define UVECTOR_LIE_DEFINED
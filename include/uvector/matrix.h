@@ -85,18 +85,20 @@ namespace uv
 		friend Vec<type::mul<S, T>, C> operator*(const Vec<S, N, K>& v, const Mat& m)
 		{
 			static_assert(N == R, "Left-multiplied vector must have dimensionality equal to matrix row count");
-			decltype(v * m) result = v[0]*m._col(0);
-			for (size_t i = 1; i < C; ++i)
-				result = result + v[i]*m._col(i);
+			// v * M = v0*row0 + ... + vR*rowR
+			decltype(v * m) result = v[0]*m._row(0);
+			for (size_t i = 1; i < R; ++i)
+				result = result + v[i]*m._row(i);
 			return result;
 		}
 		template <class S, size_t N, int K>
 		friend Vec<type::mul<T, S>, R> operator*(const Mat& m, const Vec<S, N, K>& v)
 		{
 			static_assert(N == C, "Right-multiplied vector must have dimensionality equal to matrix column count");
-			decltype(m * v) result = m._row(0)*v[0];
-			for (size_t i = 1; i < R; ++i)
-				result = result + m._row(i)*v[i];
+			// [ M0 ... MC ] * v = M0*v0 + ... + MC*vC
+			decltype(m * v) result = m._col(0)*v[0];
+			for (size_t i = 1; i < C; ++i)
+				result = result + m._col(i)*v[i];
 			return result;
 		}
 
@@ -181,15 +183,109 @@ namespace uv
 
 	namespace details
 	{
+		template <size_t N, class T>
+		constexpr auto power(T t)
+		{
+			if constexpr (N == 1)
+				return t;
+			else
+				return t * power<N - 1>(t);
+		}
+
+		// LU decomposition with partial pivoting, PA = LU, of a dimensionless row-major copy.
+		// L (unit diagonal, not stored) and U share the storage; loops have compile-time bounds so they unroll for small N.
+		template <class T, size_t N>
+		struct LUDecomposition
+		{
+			T a[N][N];
+			size_t p[N];
+			bool odd = false;
+
+			explicit LUDecomposition(const Mat<T, N, N>& m)
+			{
+				using std::abs;
+				for (size_t i = 0; i < N; ++i)
+				{
+					p[i] = i;
+					for (size_t j = 0; j < N; ++j)
+						a[i][j] = rows(m)[i][j];
+				}
+				for (size_t k = 0; k < N; ++k)
+				{
+					size_t pivot = k;
+					for (size_t i = k + 1; i < N; ++i)
+						if (abs(a[i][k]) > abs(a[pivot][k]))
+							pivot = i;
+					if (pivot != k)
+					{
+						for (size_t j = 0; j < N; ++j)
+							std::swap(a[k][j], a[pivot][j]);
+						std::swap(p[k], p[pivot]);
+						odd = !odd;
+					}
+					if (a[k][k] == T(0))
+						continue;
+					for (size_t i = k + 1; i < N; ++i)
+					{
+						const T f = a[i][k] / a[k][k];
+						a[i][k] = f;
+						for (size_t j = k + 1; j < N; ++j)
+							a[i][j] -= f * a[k][j];
+					}
+				}
+			}
+
+			T det() const
+			{
+				T d = odd ? T(-1) : T(1);
+				for (size_t k = 0; k < N; ++k)
+					d *= a[k][k];
+				return d;
+			}
+
+			Mat<T, N, N> inv() const
+			{
+				Mat<T, N, N> result;
+				for (size_t c = 0; c < N; ++c)
+				{
+					// L y = P e_c, then U x = y
+					T x[N];
+					for (size_t i = 0; i < N; ++i)
+					{
+						T s = p[i] == c ? T(1) : T(0);
+						for (size_t j = 0; j < i; ++j)
+							s -= a[i][j] * x[j];
+						x[i] = s;
+					}
+					for (size_t i = N; i-- > 0;)
+					{
+						T s = x[i];
+						for (size_t j = i + 1; j < N; ++j)
+							s -= a[i][j] * x[j];
+						x[i] = s / a[i][i];
+					}
+					for (size_t i = 0; i < N; ++i)
+						cols(result)[c][i] = x[i];
+				}
+				return result;
+			}
+		};
+
 		template <size_t R, size_t C>
 		struct square_op
 		{
 			static_assert(R == C, "Matrix must be square");
 
 			template <class T>
-			static auto det(const Mat<T, R, C>& m);
+			static auto det(const Mat<T, R, C>& m)
+			{
+				return LUDecomposition<type::identity<T>, R>(m / T(1)).det() * power<R>(T(1));
+			}
 			template <class T>
-			static auto inv(const Mat<T, R, C>& m);
+			static auto inv(const Mat<T, R, C>& m)
+			{
+				return LUDecomposition<type::identity<T>, R>(m / T(1)).inv() / T(1);
+			}
 		};
 		template <>
 		struct square_op<2, 2>
@@ -203,8 +299,8 @@ namespace uv
 			static auto inv(const Mat<T, 2, 2>& m)
 			{
 				return rows(
-					vector(rows(m)[1][1], rows(m)[1][0]),
-					vector(rows(m)[0][1], rows(m)[0][0])
+					vector( rows(m)[1][1], -rows(m)[0][1]),
+					vector(-rows(m)[1][0],  rows(m)[0][0])
 				) / det(m);
 			}
 		};
@@ -232,6 +328,34 @@ namespace uv
 
 	}
 
+	namespace details
+	{
+		// Batched matrix kernels are written once for a lane type L, which is either a scalar or a Vec<T, W> holding
+		// the same element of W independent matrices. Without data-dependent branches a lane group runs in lockstep
+		// and the compiler can keep each Vec in a SIMD register.
+		template <class U> static constexpr size_t lane_group = 32 / sizeof(U); // eight floats or four doubles, one AVX register
+
+		template <class L> L lane_sqrt(const L& x) { return sqrt(x); }
+		template <class T, size_t W> Vec<T, W> lane_sqrt(Vec<T, W> x) { for (size_t i = 0; i < W; ++i) x[i] = sqrt(x[i]); return x; }
+		template <class L> L lane_rsqrt(const L& x) { return L(scalar<L>(1)) / lane_sqrt(x); }
+
+		// Loads the dimensionless elements of the matrices m[first...] into the lanes of 'a', padding a partial group with identity matrices
+		template <class T, size_t R, size_t C, class L>
+		size_t gather_lanes(gsl::span<const Mat<T, R, C>> m, size_t first, L (&a)[R][C])
+		{
+			using U = scalar<L>;
+			const size_t n = std::min(size_t(m.size()) - first, dim<L>);
+			for (size_t i = 0; i < R; ++i)
+				for (size_t j = 0; j < C; ++j)
+				{
+					a[i][j] = L(U(i == j));
+					for (size_t k = 0; k < n; ++k)
+						a[i][j][k] = rows(m[first + k])[i][j] / T(1);
+				}
+			return n;
+		}
+	}
+
 	template <class T, size_t R, int... K> Mat<T, R, sizeof...(K)> cols(const Vec<T, R, K>&... args) { Mat<T, R, sizeof...(K)> r; cols(r).assign(args...); return r; }
 	template <class T, size_t C, int... K> Mat<T, sizeof...(K), C> rows(const Vec<T, C, K>&... args) { Mat<T, sizeof...(K), C> r; rows(r).assign(args...); return r; }
 
@@ -246,6 +370,25 @@ namespace uv
 
 	template <class T, size_t R, size_t C> auto    det(const Mat<T, R, C>& m) { return details::square_op<R, C>::det(m); }
 	template <class T, size_t R, size_t C> auto invert(const Mat<T, R, C>& m) { return details::square_op<R, C>::inv(m); }
+
+	// Inverts a matrix known to be affine, [ A t; 0 1 ], as [ A^-1  -A^-1*t; 0 1 ]; about half the cost of a general inverse
+	template <class T>
+	Mat<T, 4, 4> invert_affine(const Mat<T, 4, 4>& m)
+	{
+		Mat<T, 3, 3> A;
+		for (size_t i = 0; i < 3; ++i)
+			cols(A)[i] = cols(m)[i][axes::XYZ];
+		const auto Ai = invert(A);
+		const auto t = Ai * cols(m)[3][axes::XYZ];
+
+		Mat<T, 4, 4> result = T(1);
+		for (size_t i = 0; i < 3; ++i)
+		{
+			cols(result)[i][axes::XYZ] = cols(Ai)[i];
+			cols(result)[3][i] = -t[i];
+		}
+		return result;
+	}
 }
 
 #define UVECTOR_MATRIX_DEFINED
@@ -261,3 +404,7 @@ namespace uv
 #ifdef UVECTOR_TRANSFORM_DEFINED
 #include "cross/matrix_transform.h"
 #endif
+
+#ifdef UVECTOR_SIMD_DEFINED
+#include "cross/matrix_simd.h"
+#endif
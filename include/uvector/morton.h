@@ -0,0 +1,230 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#include "reduce.h"
+
+namespace uv
+{
+	namespace details
+	{
+		// Spreads the low bits of x so that N-1 zero bits separate them
+		template <size_t N>
+		uint32_t spread32(uint32_t x)
+		{
+			static_assert(N == 2 || N == 3, "space-filling codes are implemented for two and three dimensions");
+#if defined(__BMI2__)
+			return _pdep_u32(x, N == 3 ? 0x09249249u : 0x55555555u);
+#else
+			if constexpr (N == 3)
+			{
+				x &= 0x3ff;
+				x = (x | x << 16) & 0x030000ffu;
+				x = (x | x << 8)  & 0x0300f00fu;
+				x = (x | x << 4)  & 0x030c30c3u;
+				x = (x | x << 2)  & 0x09249249u;
+			}
+			else
+			{
+				x &= 0x7fff;
+				x = (x | x << 8) & 0x00ff00ffu;
+				x = (x | x << 4) & 0x0f0f0f0fu;
+				x = (x | x << 2) & 0x33333333u;
+				x = (x | x << 1) & 0x55555555u;
+			}
+			return x;
+#endif
+		}
+		template <size_t N>
+		uint64_t spread64(uint64_t x)
+		{
+			static_assert(N == 2 || N == 3, "space-filling codes are implemented for two and three dimensions");
+#if defined(__BMI2__) && defined(__x86_64__)
+			return _pdep_u64(x, N == 3 ? 0x1249249249249249ull : 0x5555555555555555ull);
+#else
+			if constexpr (N == 3)
+			{
+				x &= 0x1fffff;
+				x = (x | x << 32) & 0x001f00000000ffffull;
+				x = (x | x << 16) & 0x001f0000ff0000ffull;
+				x = (x | x << 8)  & 0x100f00f00f00f00full;
+				x = (x | x << 4)  & 0x10c30c30c30c30c3ull;
+				x = (x | x << 2)  & 0x1249249249249249ull;
+			}
+			else
+			{
+				x &= 0x7fffffff;
+				x = (x | x << 16) & 0x0000ffff0000ffffull;
+				x = (x | x << 8)  & 0x00ff00ff00ff00ffull;
+				x = (x | x << 4)  & 0x0f0f0f0f0f0f0f0full;
+				x = (x | x << 2)  & 0x3333333333333333ull;
+				x = (x | x << 1)  & 0x5555555555555555ull;
+			}
+			return x;
+#endif
+		}
+		template <class C, size_t N> C spread(uint32_t x) { if constexpr (sizeof(C) > 4) return spread64<N>(x); else return spread32<N>(x); }
+
+		// Bits per axis of a code of type C: 10 or 15 in 32 bits, 21 or 31 in 64 bits
+		template <class C, size_t N> static constexpr uint32_t code_bits = uint32_t((sizeof(C) > 4 ? 63 : 30) / N);
+
+		// The cell of 'p' in a grid of 2^bits cells along each axis of 'domain', clamping points outside it
+		template <class T, size_t N, int K>
+		Vec<uint32_t, N> quantize(const Point<T, N>& p, const Vec<Bounds<T>, N, K>& domain, uint32_t bits)
+		{
+			using U = type::identity<T>;
+			const uint32_t cells = uint32_t(1) << bits;
+			Vec<uint32_t, N> q;
+			for (size_t k = 0; k < N; ++k)
+			{
+				const U x = (p.v[k] - domain[k].min) / (domain[k].max - domain[k].min) * U(cells);
+				// NaN from an empty or flat axis goes to the first cell
+				q[k] = x > U(0) ? (x < U(cells) ? uint32_t(x) : cells - 1) : 0;
+			}
+			return q;
+		}
+
+		template <class C, size_t N>
+		C interleave(const Vec<uint32_t, N>& q)
+		{
+			C code = 0;
+			for (size_t k = 0; k < N; ++k)
+				code |= spread<C, N>(q[k]) << k;
+			return code;
+		}
+
+		// Position of the cell q along the Hilbert curve through a grid of 2^bits cells per axis, after J. Skilling,
+		// "Programming the Hilbert curve" (2004): the cell is transformed in place, then read with axis 0 as the most significant bit of each level
+		template <class C, size_t N>
+		C hilbert_index(Vec<uint32_t, N> q, uint32_t bits)
+		{
+			const uint32_t top = uint32_t(1) << (bits - 1);
+			for (uint32_t m = top; m > 1; m >>= 1)
+			{
+				const uint32_t low = m - 1;
+				for (size_t k = 0; k < N; ++k)
+				{
+					// invert the low bits of q[0] if bit m of q[k] is set, otherwise exchange them with those of q[k], without branching
+					const uint32_t set = 0u - uint32_t((q[k] & m) != 0);
+					const uint32_t t = (q[0] ^ q[k]) & low & ~set;
+					q[0] ^= (low & set) | t;
+					q[k] ^= t;
+				}
+			}
+			for (size_t k = 1; k < N; ++k)
+				q[k] ^= q[k - 1];
+			uint32_t t = 0;
+			for (uint32_t m = top; m > 1; m >>= 1)
+				t ^= (m - 1) & (0u - uint32_t((q[N - 1] & m) != 0));
+			C code = 0;
+			for (size_t k = 0; k < N; ++k)
+				code |= spread<C, N>(q[k] ^ t) << (N - 1 - k);
+			return code;
+		}
+
+		static constexpr size_t radix_bits = 8;
+		static constexpr size_t radix_size = size_t(1) << radix_bits;
+		static constexpr size_t radix_chunk = 1 << 16;
+
+		// Stable least-significant-digit radix sort of 'keys', carrying 'index' along. Each pass counts the digits of
+		// every chunk on the threads, then scatters the chunks in parallel to offsets that keep them in order.
+		template <class C>
+		void radix_sort(std::vector<C>& keys, std::vector<uint32_t>& index, size_t threads)
+		{
+			const size_t n = keys.size();
+			const size_t chunks = (n + radix_chunk - 1) / radix_chunk;
+			std::vector<C> keys_out(n);
+			std::vector<uint32_t> index_out(n);
+			std::vector<size_t> offsets(chunks * radix_size);
+			for (size_t shift = 0; shift < 8*sizeof(C); shift += radix_bits)
+			{
+				parallel_for(chunks, threads, [&](size_t c)
+				{
+					size_t* h = &offsets[c*radix_size];
+					std::fill(h, h + radix_size, size_t(0));
+					for (size_t i = c*radix_chunk; i < std::min(n, (c + 1)*radix_chunk); ++i)
+						++h[(keys[i] >> shift) & (radix_size - 1)];
+				});
+				size_t total = 0;
+				bool trivial = false;
+				for (size_t d = 0; d < radix_size; ++d)
+				{
+					const size_t first = total;
+					for (size_t c = 0; c < chunks; ++c)
+					{
+						const size_t count = offsets[c*radix_size + d];
+						offsets[c*radix_size + d] = total;
+						total += count;
+					}
+					trivial = trivial || total - first == n;
+				}
+				// every key has the same digit, so the pass would not move anything
+				if (trivial)
+					continue;
+				parallel_for(chunks, threads, [&](size_t c)
+				{
+					size_t* h = &offsets[c*radix_size];
+					for (size_t i = c*radix_chunk; i < std::min(n, (c + 1)*radix_chunk); ++i)
+					{
+						const size_t j = h[(keys[i] >> shift) & (radix_size - 1)]++;
+						keys_out[j] = keys[i];
+						index_out[j] = index[i];
+					}
+				});
+				keys.swap(keys_out);
+				index.swap(index_out);
+			}
+		}
+	}
+
+	// Position along the Z-order curve through a grid dividing 'domain', with axis 0 in the lowest bit. The grid has
+	// 2^10 (uint32_t) or 2^21 (uint64_t) cells along each axis in three dimensions, and 2^15 or 2^31 in two.
+	template <class C = uint32_t, class T, size_t N, int K>
+	C morton_code(const Point<T, N>& p, const Vec<Bounds<T>, N, K>& domain)
+	{
+		return details::interleave<C, N>(details::quantize(p, domain, details::code_bits<C, N>));
+	}
+
+	// Position along the Hilbert curve through the same cells. It costs more than morton_code, but consecutive codes are always
+	// neighbouring cells, which keeps ranges of sorted points more compact.
+	template <class C = uint32_t, class T, size_t N, int K>
+	C hilbert_code(const Point<T, N>& p, const Vec<Bounds<T>, N, K>& domain)
+	{
+		return details::hilbert_index<C, N>(details::quantize(p, domain, details::code_bits<C, N>), details::code_bits<C, N>);
+	}
+
+	// Sorts 'codes' in increasing order, stably, reordering each of 'values' along with them, on all hardware threads
+	template <class C, class... V>
+	void radix_sort(gsl::span<C> codes, gsl::span<V>... values)
+	{
+		static_assert(std::is_unsigned_v<C>, "codes must be unsigned integers");
+		std::vector<C> keys(codes.begin(), codes.end());
+		std::vector<uint32_t> index(keys.size());
+		for (size_t i = 0; i < index.size(); ++i)
+			index[i] = uint32_t(i);
+		details::radix_sort(keys, index, 0);
+		std::copy(keys.begin(), keys.end(), codes.begin());
+		(details::permute(values, index, 0), ...);
+	}
+
+	// Reorders the points, and the payloads attached to them, along the Morton curve through their bounds
+	template <class T, size_t N, class... V>
+	void morton_sort(gsl::span<Point<T, N>> points, gsl::span<V>... payload)
+	{
+		const auto domain = bounds(gsl::span<const Point<T, N>>(points.data(), points.size()));
+		std::vector<uint32_t> codes(points.size());
+		details::parallel_for((codes.size() + details::radix_chunk - 1) / details::radix_chunk, 0, [&](size_t c)
+		{
+			for (size_t i = c*details::radix_chunk; i < std::min(codes.size(), (c + 1)*details::radix_chunk); ++i)
+				codes[i] = morton_code(points[i], domain);
+		});
+		radix_sort(gsl::span<uint32_t>(codes.data(), codes.size()), points, payload...);
+	}
+}
+
+#define UVECTOR_MORTON_DEFINED
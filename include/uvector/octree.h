@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "bvh.h"
+#include "morton.h"
+#include "reduce.h"
+
+namespace uv
+{
+	// Linear octree over point masses or charges, for Barnes-Hut summation of inverse square fields in O(n log n).
+	// The bodies are sorted along the Morton curve, so every node is a contiguous range of them and its children
+	// are the runs sharing the next three bits of the code. Nodes are stored depth first, each with the index of
+	// the node that follows its subtree, so traversals need no stack and read the array forward.
+	// T is the type of the coordinates and Q that of the masses or charges, and both units carry through to the field.
+	template <class T, class Q = type::identity<T>>
+	class Octree
+	{
+	public:
+		using U = type::identity<T>;
+		using M = type::mul<T>;
+		// Q/T^2, the unit of the field of a body
+		using Field = type::div<Q, M>;
+
+		struct Node
+		{
+			Bounds3<T> box; // of the bodies, not of the octant
+			Point3<T> center; // of the bodies weighted by the magnitude of their masses or charges
+			Q mass; // the sum of the masses or charges
+			M size2; // the square of the diagonal of the box
+			uint32_t first, count; // the bodies of the node, in sorted order
+			uint32_t next; // the node after the subtree, which for leaves is the next node
+		};
+
+		static constexpr size_t leaf_size = 8;
+
+	private:
+		static constexpr uint32_t _levels = details::code_bits<uint64_t, 3>;
+
+		std::vector<Node> _nodes;
+		std::vector<Point3<T>> _points;
+		std::vector<Q> _masses;
+		std::vector<uint32_t> _indices;
+		std::vector<Q> _weights; // the sums of the magnitudes of the masses or charges of the nodes
+
+		void _build(const std::vector<uint64_t>& codes, uint32_t first, uint32_t last, uint32_t level)
+		{
+			const uint32_t node = uint32_t(_nodes.size());
+			// the box and center, whose vectors a value-initialized Node leaves indeterminate, are set by _summarize()
+			Node n{};
+			for (size_t k = 0; k < 3; ++k)
+				n.box[k] = empty;
+			n.center = point(Vec3<T>(T(0)));
+			n.first = first;
+			n.count = last - first;
+			_nodes.push_back(n);
+			// levels where all the bodies fall in the same octant add nothing
+			while (level < _levels && last - first > leaf_size && ((codes[first] ^ codes[last - 1]) >> 3*(_levels - 1 - level)) == 0)
+				++level;
+			if (level < _levels && last - first > leaf_size)
+			{
+				const uint32_t shift = 3*(_levels - 1 - level);
+				for (uint32_t begin = first; begin < last;)
+				{
+					const uint64_t octant = codes[begin] >> shift;
+					const uint32_t end = uint32_t(std::partition_point(codes.begin() + begin, codes.begin() + last,
+						[&](uint64_t c) { return (c >> shift) == octant; }) - codes.begin());
+					_build(codes, begin, end, level + 1);
+					begin = end;
+				}
+			}
+			_nodes[node].next = uint32_t(_nodes.size());
+		}
+
+		// Fills in the bounds and moments of the nodes, children first
+		void _summarize()
+		{
+			const auto magnitude = [](Q q) { return q < Q(0) ? -q : q; };
+			for (size_t i = _nodes.size(); i-- > 0;)
+			{
+				Node& node = _nodes[i];
+				Bounds3<T> box;
+				for (size_t k = 0; k < 3; ++k)
+					box[k] = empty;
+				Q mass = Q(0), weight = Q(0);
+				Vec3<type::mul<Q, T>> moment(type::mul<Q, T>(0));
+				if (node.next == i + 1)
+					for (uint32_t j = node.first; j < node.first + node.count; ++j)
+					{
+						details::grow(box, _points[j].v);
+						mass = mass + _masses[j];
+						weight = weight + magnitude(_masses[j]);
+						moment = moment + _points[j].v * magnitude(_masses[j]);
+					}
+				else
+					for (size_t c = i + 1; c < node.next; c = _nodes[c].next)
+					{
+						const Node& child = _nodes[c];
+						details::grow(box, child.box);
+						mass = mass + child.mass;
+						weight = weight + _weights[c];
+						moment = moment + child.center.v * _weights[c];
+					}
+				node.box = box;
+				node.mass = mass;
+				// bodies without mass or charge are centered on their bounds
+				node.center = weight > Q(0) ? point(moment / weight) : point(uv::mean(box));
+				// rounding can move the center out of the box, eg. off a single body, which then would not be left out
+				for (size_t k = 0; k < 3; ++k)
+				{
+					const T c = node.center.v[k];
+					node.center.v[k] = c < box[k].min ? box[k].min : (box[k].max < c ? box[k].max : c);
+				}
+				node.size2 = square(span(box));
+				_weights[i] = weight;
+			}
+		}
+
+	public:
+		Octree() = default;
+		Octree(gsl::span<const Point3<T>> points, gsl::span<const Q> masses) { build(points, masses); }
+
+		void build(gsl::span<const Point3<T>> points, gsl::span<const Q> masses)
+		{
+			Expects(points.size() == masses.size() && size_t(points.size()) < std::numeric_limits<uint32_t>::max());
+			const size_t n = points.size();
+			_nodes.clear();
+			if (n == 0)
+			{
+				_points.clear();
+				_masses.clear();
+				_indices.clear();
+				return;
+			}
+			const auto domain = bounds(points);
+			std::vector<uint64_t> codes(n);
+			_indices.resize(n);
+			details::parallel_for((n + details::radix_chunk - 1) / details::radix_chunk, 0, [&](size_t c)
+			{
+				for (size_t i = c*details::radix_chunk; i < std::min(n, (c + 1)*details::radix_chunk); ++i)
+				{
+					codes[i] = morton_code<uint64_t>(points[i], domain);
+					_indices[i] = uint32_t(i);
+				}
+			});
+			details::radix_sort(codes, _indices, 0);
+			_points.resize(n);
+			_masses.resize(n);
+			for (size_t i = 0; i < n; ++i)
+			{
+				_points[i] = points[_indices[i]];
+				_masses[i] = masses[_indices[i]];
+			}
+			_build(codes, 0, uint32_t(n), 0);
+			_weights.resize(_nodes.size());
+			_summarize();
+		}
+
+		size_t size() const { return _points.size(); }
+		const std::vector<Node>& nodes() const { return _nodes; }
+		// The bodies in the order of the nodes, and the position of each in the spans given to build()
+		const std::vector<Point3<T>>& points() const { return _points; }
+		uint32_t index(size_t i) const { return _indices[i]; }
+
+		// The sum over the bodies of q (s - p) / (|s - p|^2 + softening2)^(3/2), where s is the position of a body and q
+		// its mass or charge: times G it is the gravitational acceleration at p, times -k the electric field. Nodes are
+		// taken as a whole, at their center and with their total mass, when their diagonal is less than 'theta' times
+		// their distance to p, with 0 giving the exact sum. Bodies exactly at p are left out.
+		Vec3<Field> field(const Point3<T>& p, U theta, M softening2 = M(0)) const
+		{
+			Expects(!(theta < U(0)) && !(U(1) < theta));
+			const U theta2 = theta*theta;
+			Vec3<Field> acc(Field(0));
+			const auto add = [&](const Vec3<T>& d, Q q)
+			{
+				const M r2 = square(d);
+				const auto inv = U(1) / sqrt(r2 + softening2);
+				const auto w = q * (inv*inv*inv);
+				acc = acc + d * (r2 > M(0) ? w : decltype(w)(0));
+			};
+			for (size_t i = 0; i < _nodes.size();)
+			{
+				const Node& node = _nodes[i];
+				const Vec3<T> d = node.center - p;
+				if (node.size2 < theta2 * square(d))
+					add(d, node.mass);
+				else if (node.next != i + 1)
+				{
+					++i;
+					continue;
+				}
+				else
+					for (uint32_t j = node.first; j < node.first + node.count; ++j)
+						add(_points[j] - p, _masses[j]);
+				i = node.next;
+			}
+			return acc;
+		}
+
+		// The field at every body, written in the order of the spans given to build(), with the bodies divided among
+		// all hardware threads in runs along the curve, so consecutive traversals open mostly the same nodes
+		void field(gsl::span<Vec3<Field>> result, U theta, M softening2 = M(0)) const
+		{
+			Expects(size_t(result.size()) == size());
+			constexpr size_t chunk = 256;
+			details::parallel_for((size() + chunk - 1) / chunk, 0, [&](size_t c)
+			{
+				for (size_t i = c*chunk; i < std::min(size(), (c + 1)*chunk); ++i)
+					result[_indices[i]] = field(_points[i], theta, softening2);
+			});
+		}
+	};
+}
+
+#define UVECTOR_OCTREE_DEFINED
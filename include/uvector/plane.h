@@ -0,0 +1,41 @@
+#pragma once
+
+#include "vector.h"
+
+namespace uv
+{
+	// The points p where dot(normal, p) + offset == 0, with positive distances on the side the normal points to
+	template <class T>
+	struct Plane
+	{
+		using U = type::identity<T>;
+
+		Dir3<U> normal;
+		T offset;
+
+		Plane() : normal(axes::Z), offset(T(0)) { }
+		constexpr Plane(const Dir3<U>& normal, T offset) : normal(normal), offset(offset) { }
+
+		// Normalizes a*x + b*y + c*z + d = 0, as read off a projection matrix
+		static Plane fromCoefficients(const Vec3<U>& abc, T d)
+		{
+			const auto n = decompose(abc);
+			return { n.direction, d / n.length };
+		}
+
+		friend T distance(const Plane& p, const Vec3<T>& x) { return dot(p.normal, x) + p.offset; }
+
+		Plane operator-() const { return { Dir3<U>::fromUnchecked(-normal), -offset }; }
+	};
+
+	template <class T> Plane<T> plane(const Dir3<type::identity<T>>& normal, const Vec3<T>& point) { return { normal, -dot(normal, point) }; }
+
+	// The plane through three points, facing the side from which they wind counter-clockwise
+	template <class T>
+	Plane<T> plane(const Vec3<T>& a, const Vec3<T>& b, const Vec3<T>& c) { return plane(direction(cross(b - a, c - a)), a); }
+
+	using Planef = Plane<float>;
+	using Planed = Plane<double>;
+}
+
+#define UVECTOR_PLANE_DEFINED
@@ -126,6 +126,20 @@ namespace uv
 	}
 }
 
+namespace std
+{
+	template <class T, size_t N, int K>
+	struct hash<uv::Point<T, N, K>>
+	{
+		size_t operator()(const uv::Point<T, N, K>& p) const noexcept { return hash<uv::Vec<T, N, K>>()(p.v); }
+	};
+	template <class T, size_t N, int K>
+	struct equal_to<uv::Point<T, N, K>>
+	{
+		bool operator()(const uv::Point<T, N, K>& a, const uv::Point<T, N, K>& b) const { return all(a.v == b.v); }
+	};
+}
+
 #define UVECTOR_POINT_DEFINED
 
 #ifdef UVECTOR_MATRIX_DEFINED
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "array.h"
+#include "bounds.h"
+
+namespace uv
+{
+	// A half-line origin + t*direction, t >= 0, keeping the component-wise inverse of the direction for slab tests
+	template <class T, size_t N>
+	struct Ray
+	{
+		using U = type::identity<T>;
+
+		Vec<T, N> origin;
+		Vec<U, N> direction;
+		Vec<U, N> inverse;
+
+		Ray(const Vec<T, N>& origin, const Vec<U, N>& direction) : origin(origin), direction(direction), inverse(U(1) / direction) { }
+
+		Vec<T, N> operator()(T t) const { return origin + direction*t; }
+	};
+
+	template <class T> using Ray2 = Ray<T, 2>;
+	template <class T> using Ray3 = Ray<T, 3>;
+
+	using Ray2f = Ray<float, 2>;
+	using Ray3f = Ray<float, 3>;
+	using Ray2d = Ray<double, 2>;
+	using Ray3d = Ray<double, 3>;
+
+	// Structure-of-arrays storage for many boxes, keeping the lower and upper corners in separate vector arrays
+	template <class T, size_t N>
+	class BoundsArray
+	{
+		VecArray<T, N> _min;
+		VecArray<T, N> _max;
+	public:
+		using value_type = Vec<Bounds<T>, N>;
+
+		BoundsArray() = default;
+		explicit BoundsArray(gsl::span<const Vec<Bounds<T>, N>> boxes)
+		{
+			reserve(boxes.size());
+			for (const auto& box : boxes)
+				push_back(box);
+		}
+
+		void reserve(size_t n) { _min.reserve(n); _max.reserve(n); }
+		void clear() { _min.clear(); _max.clear(); }
+		template <int K>
+		void push_back(const Vec<Bounds<T>, N, K>& box) { _min.push_back(min(box)); _max.push_back(max(box)); }
+
+		size_t size() const { return _min.size(); }
+		bool empty() const { return _min.empty(); }
+
+		value_type operator[](size_t i) const
+		{
+			value_type box;
+			for (size_t k = 0; k < N; ++k)
+			{
+				box[k].min = _min.lane(k)[i];
+				box[k].max = _max.lane(k)[i];
+			}
+			return box;
+		}
+		template <int K>
+		void set(size_t i, const Vec<Bounds<T>, N, K>& box) { _min.set(i, min(box)); _max.set(i, max(box)); }
+
+		friend VecArray<T, N>& min(BoundsArray& b) { return b._min; }
+		friend VecArray<T, N>& max(BoundsArray& b) { return b._max; }
+		friend const VecArray<T, N>& min(const BoundsArray& b) { return b._min; }
+		friend const VecArray<T, N>& max(const BoundsArray& b) { return b._max; }
+	};
+
+	template <class T> using Bounds3SoA = BoundsArray<T, 3>;
+
+	// The range of t for which ray(t) is inside the box, empty if the ray misses it.
+	// Picking the near and far planes from the sign of the direction keeps empty boxes empty, and
+	// the comparisons skip the NaN from an origin on a plane parallel to the ray.
+	template <class T, size_t N, int K>
+	Bounds<T> intersect(const Ray<T, N>& ray, const Vec<Bounds<T>, N, K>& box)
+	{
+		T t0 = T(0), t1 = std::numeric_limits<T>::infinity();
+		for (size_t k = 0; k < N; ++k)
+		{
+			const bool negative = ray.inverse[k] < 0;
+			const T near = ((negative ? box[k].max : box[k].min) - ray.origin[k]) * ray.inverse[k];
+			const T far  = ((negative ? box[k].min : box[k].max) - ray.origin[k]) * ray.inverse[k];
+			t0 = near > t0 ? near : t0;
+			t1 = far  < t1 ? far  : t1;
+		}
+		Bounds<T> result = empty;
+		if (t0 <= t1)
+		{
+			result.min = t0;
+			result.max = t1;
+		}
+		return result;
+	}
+
+	// Slab test of one ray against every box, writing the entry distances and whether the ray enters each box before 'tmax';
+	// returns the number of hits. The loop is free of branches so it compiles to packed code testing 4 or 8 boxes at a time.
+	template <class T, size_t N>
+	size_t intersect(const Ray<T, N>& ray, const BoundsArray<T, N>& boxes, T tmax, gsl::span<T> entry, gsl::span<bool> hit)
+	{
+		Expects(size_t(entry.size()) == boxes.size() && size_t(hit.size()) == boxes.size());
+		const T* near[N];
+		const T* far[N];
+		for (size_t k = 0; k < N; ++k)
+		{
+			const bool negative = ray.inverse[k] < 0;
+			near[k] = negative ? max(boxes).lane(k) : min(boxes).lane(k);
+			far[k]  = negative ? min(boxes).lane(k) : max(boxes).lane(k);
+		}
+		T* e = entry.data();
+		bool* h = hit.data();
+		size_t hits = 0;
+		for (size_t i = 0; i < boxes.size(); ++i)
+		{
+			T t0 = T(0), t1 = tmax;
+			for (size_t k = 0; k < N; ++k)
+			{
+				const T a = (near[k][i] - ray.origin[k]) * ray.inverse[k];
+				const T b = (far[k][i] - ray.origin[k]) * ray.inverse[k];
+				t0 = a > t0 ? a : t0;
+				t1 = b < t1 ? b : t1;
+			}
+			e[i] = t0;
+			h[i] = t0 <= t1;
+			hits += t0 <= t1;
+		}
+		return hits;
+	}
+}
+
+#define UVECTOR_RAY_DEFINED
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "bounds.h"
+#include "point.h"
+
+namespace uv
+{
+	namespace details
+	{
+		// Points reduced in one vectorized pass, and points per task. Both are fixed, so the order in which
+		// values are added depends only on the number of points and the results are the same on any number of threads.
+		static constexpr size_t reduce_block = 256;
+		static constexpr size_t reduce_chunk = 1 << 16;
+
+		// Calls f(i) for every i in [0, n) on up to 'threads' threads, zero meaning one per hardware thread
+		template <class F>
+		void parallel_for(size_t n, size_t threads, F&& f)
+		{
+			if (threads == 0)
+				threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+			threads = std::min(threads, n);
+			if (threads <= 1)
+			{
+				for (size_t i = 0; i < n; ++i)
+					f(i);
+				return;
+			}
+			std::atomic<size_t> next{ 0 };
+			const auto work = [&] { for (size_t i; (i = next++) < n;) f(i); };
+			std::vector<std::thread> pool;
+			pool.reserve(threads - 1);
+			for (size_t t = 1; t < threads; ++t)
+				pool.emplace_back(work);
+			work();
+			for (auto& t : pool)
+				t.join();
+		}
+
+		// Reorders values so that values[i] becomes the old values[index[i]], through a temporary copy
+		template <class V>
+		void permute(gsl::span<V> values, const std::vector<uint32_t>& index, size_t threads)
+		{
+			Expects(size_t(values.size()) == index.size());
+			std::vector<V> source(values.begin(), values.end());
+			parallel_for((index.size() + reduce_chunk - 1) / reduce_chunk, threads, [&](size_t c)
+			{
+				for (size_t i = c*reduce_chunk; i < std::min(index.size(), (c + 1)*reduce_chunk); ++i)
+					values[i] = source[index[i]];
+			});
+		}
+
+		// Combines the n > 0 partial results in a balanced tree, in place, keeping the rounding error of sums logarithmic
+		template <class R, class OP>
+		R pairwise(R* r, size_t n, OP op)
+		{
+			for (size_t step = 1; step < n; step *= 2)
+				for (size_t i = 0; i + step < n; i += 2*step)
+					r[i] = op(r[i], r[i + step]);
+			return r[0];
+		}
+
+		// The kernels see the points as a flat array of components, accumulated in W lanes with lane j holding component j % N
+		template <size_t N> static constexpr size_t reduce_lanes = 8*N;
+
+		template <class T, size_t N>
+		Vec<T, N> sum_block(const T* x, size_t n)
+		{
+			constexpr size_t W = reduce_lanes<N>;
+			T acc[W];
+			std::fill(acc, acc + W, T(0));
+			const size_t m = n*N;
+			size_t i = 0;
+			for (; i + W <= m; i += W)
+				for (size_t j = 0; j < W; ++j)
+					acc[j] = acc[j] + x[i + j];
+			Vec<T, N> s(T(0));
+			for (size_t j = 0; j < W; ++j)
+				s[j % N] = s[j % N] + acc[j];
+			for (; i < m; ++i)
+				s[i % N] = s[i % N] + x[i];
+			return s;
+		}
+
+		template <class T, size_t N>
+		Vec<Bounds<T>, N> bounds_block(const T* x, size_t n)
+		{
+			constexpr size_t W = reduce_lanes<N>;
+			T lo[W], hi[W];
+			std::fill(lo, lo + W, Bounds<T>::no_min);
+			std::fill(hi, hi + W, Bounds<T>::no_max);
+			const size_t m = n*N;
+			size_t i = 0;
+			for (; i + W <= m; i += W)
+				for (size_t j = 0; j < W; ++j)
+				{
+					lo[j] = x[i + j] < lo[j] ? x[i + j] : lo[j];
+					hi[j] = hi[j] < x[i + j] ? x[i + j] : hi[j];
+				}
+			for (; i < m; ++i)
+			{
+				lo[i % W] = x[i] < lo[i % W] ? x[i] : lo[i % W];
+				hi[i % W] = hi[i % W] < x[i] ? x[i] : hi[i % W];
+			}
+			Vec<Bounds<T>, N> b;
+			for (size_t k = 0; k < N; ++k)
+				b[k] = empty;
+			for (size_t j = 0; j < W; ++j)
+			{
+				b[j % N].min = lo[j] < b[j % N].min ? lo[j] : b[j % N].min;
+				b[j % N].max = b[j % N].max < hi[j] ? hi[j] : b[j % N].max;
+			}
+			return b;
+		}
+
+		// Reduces chunks on the threads and blocks within each chunk, combining both levels pairwise
+		template <class R, class T, class BLOCK, class OP>
+		R reduce(const T* x, size_t n, size_t dim, size_t threads, R identity, BLOCK block, OP op)
+		{
+			const size_t chunks = (n + reduce_chunk - 1) / reduce_chunk;
+			if (chunks == 0)
+				return identity;
+			std::vector<R> partial(chunks);
+			parallel_for(chunks, threads, [&](size_t c)
+			{
+				const size_t first = c*reduce_chunk, count = std::min(reduce_chunk, n - first);
+				R blocks[reduce_chunk / reduce_block];
+				const size_t m = (count + reduce_block - 1) / reduce_block;
+				for (size_t b = 0; b < m; ++b)
+					blocks[b] = block(x + (first + b*reduce_block)*dim, std::min(reduce_block, count - b*reduce_block));
+				partial[c] = pairwise(blocks, m, op);
+			});
+			return pairwise(partial.data(), chunks, op);
+		}
+
+		template <class T, size_t N>
+		const T* components(gsl::span<const Point<T, N>> points)
+		{
+			static_assert(sizeof(Point<T, N>) == N*sizeof(T), "points must be packed");
+			return points.empty() ? nullptr : &points[0].v[0];
+		}
+
+		template <class T, size_t N>
+		Vec<T, N> sum_points(gsl::span<const Point<T, N>> points, size_t threads)
+		{
+			return reduce(components(points), size_t(points.size()), N, threads, Vec<T, N>(T(0)), &sum_block<T, N>,
+				[](const Vec<T, N>& a, const Vec<T, N>& b) { return a + b; });
+		}
+
+		template <class T, size_t N>
+		Vec<Bounds<T>, N> bounds_points(gsl::span<const Point<T, N>> points, size_t threads)
+		{
+			Vec<Bounds<T>, N> none;
+			for (size_t k = 0; k < N; ++k)
+				none[k] = empty;
+			return reduce(components(points), size_t(points.size()), N, threads, none, &bounds_block<T, N>,
+				[](const Vec<Bounds<T>, N>& a, const Vec<Bounds<T>, N>& b) { return uv::bounds(a, b); });
+		}
+	}
+
+	// Reductions over point clouds of any size, on all hardware threads, with results independent of their number
+
+	template <class T, size_t N>
+	Vec<T, N> sum(gsl::span<const Point<T, N>> points) { return details::sum_points(points, 0); }
+
+	template <class T, size_t N>
+	Point<T, N> mean(gsl::span<const Point<T, N>> points)
+	{
+		Expects(!points.empty());
+		return point(details::sum_points(points, 0) / type::identity<T>(points.size()));
+	}
+
+	template <class T, size_t N>
+	Vec<Bounds<T>, N> bounds(gsl::span<const Point<T, N>> points) { return details::bounds_points(points, 0); }
+}
+
+#define UVECTOR_REDUCE_DEFINED
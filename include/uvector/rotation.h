@@ -135,6 +135,11 @@ namespace uv
 	template <class T> constexpr auto operator*(Rot2<T> r, Angle a) { return r * rotation(a); }
 	template <class T> constexpr auto operator*(Angle a, Rot2<T> r) { return rotation(a) * r; }
 
+	constexpr Rot2<float> rotation(Anglef angle) { float s = 0, c = 0; sincos(angle, s, c); return { Dir2<float>::fromUnchecked(Vec2<float>(c, s)) }; }
+
+	template <class T> constexpr auto operator*(Rot2<T> r, Anglef a) { return r * rotation(a); }
+	template <class T> constexpr auto operator*(Anglef a, Rot2<T> r) { return rotation(a) * r; }
+
 
 	// A rotation in three dimensions represented as a unit quaternion
 	template <class T>
@@ -193,6 +198,85 @@ namespace uv
 	template <class T>
 	Rot3<T> rotation(const Quat<T>& q) { return decompose(q).direction; }
 
+	namespace details
+	{
+		// The coefficients of the series of sin(t*angle)/sin(angle) in cos(angle) - 1: u[i] = 1/((i + 1)(2i + 3)) and
+		// v[i] = (i + 1)/(2i + 3), with the last pair scaled to make up for the terms left out
+		constexpr double slerp_u(size_t i) { return (i == 7 ? 1.85298109240830 : 1.0) / double((i + 1)*(2*i + 3)); }
+		constexpr double slerp_v(size_t i) { return (i == 7 ? 1.85298109240830 : 1.0) * double(i + 1) / double(2*i + 3); }
+
+		// Interpolates between the unit quaternions a and b, given as re, im[0], im[1], im[2], along the shorter arc,
+		// with the slerp weights evaluated as polynomials in their cosine, after Eberly, "A Fast and Accurate Algorithm
+		// for Computing SLERP" (2011). Within 2e-5 of slerp, and without branches or transcendental functions, so the
+		// same steps written out over arrays of interpolations vectorize, as in RotationTracks::sample.
+		template <class T>
+		void fast_slerp(const T* a, const T* b, T t, T* r)
+		{
+			const T d = a[0]*b[0] + a[1]*b[1] + a[2]*b[2] + a[3]*b[3];
+			const T sign = d < T(0) ? T(-1) : T(1);
+			const T x = d*sign - T(1);
+			const T s = T(1) - t;
+			T ct = T(1), cs = T(1);
+			for (size_t i = 8; i-- > 0;)
+			{
+				ct = T(1) + (T(slerp_u(i))*t*t - T(slerp_v(i)))*x*ct;
+				cs = T(1) + (T(slerp_u(i))*s*s - T(slerp_v(i)))*x*cs;
+			}
+			const T wa = s*cs, wb = sign*t*ct;
+			for (size_t i = 0; i < 4; ++i)
+				r[i] = a[i]*wa + b[i]*wb;
+		}
+	}
+
+	// Interpolation between rotations along the shorter arc, giving a at t = 0 and b at t = 1.
+	// nlerp normalizes the linear blend of the quaternions, which is cheap and exact at the ends and in the middle
+	// but speeds up towards the middle of large arcs; slerp moves at constant angular speed; fast_slerp is within
+	// 2e-5 radians of slerp without its acos and sines.
+
+	template <class T>
+	Rot3<T> nlerp(const Rot3<T>& a, const Rot3<T>& b, T t)
+	{
+		const Quat<T>& qa = quaternion(a);
+		const Quat<T>& qb = quaternion(b);
+		const Quat<T> q = qa*(T(1) - t) + qb*(dot(qa, qb) < T(0) ? -t : t);
+		return Rot3<T>::fromUnchecked(q / length(q));
+	}
+
+	template <class T>
+	Rot3<T> slerp(const Rot3<T>& a, const Rot3<T>& b, T t)
+	{
+		const Quat<T>& qa = quaternion(a);
+		Quat<T> qb = quaternion(b);
+		T d = dot(qa, qb);
+		if (d < T(0))
+		{
+			qb = -qb;
+			d = -d;
+		}
+		// sin(angle) loses precision when the rotations are close, where the linear blend is accurate
+		if (d > T(0.9995))
+			return nlerp(a, Rot3<T>::fromUnchecked(qb), t);
+		const T angle = acos(d);
+		const T s = T(1) / sin(angle);
+		return Rot3<T>::fromUnchecked(qa*(sin((T(1) - t)*angle)*s) + qb*(sin(t*angle)*s));
+	}
+
+	template <class T>
+	Rot3<T> fast_slerp(const Rot3<T>& a, const Rot3<T>& b, T t)
+	{
+		const Quat<T>& qa = quaternion(a);
+		const Quat<T>& qb = quaternion(b);
+		const T ca[4] = { qa.re, qa.im[0], qa.im[1], qa.im[2] };
+		const T cb[4] = { qb.re, qb.im[0], qb.im[1], qb.im[2] };
+		T r[4];
+		details::fast_slerp(ca, cb, t, r);
+		return Rot3<T>::fromUnchecked(quaternion(r[0], vector(r[1], r[2], r[3])));
+	}
+
+	// The generic interpolate() would blend the quaternions linearly and denormalize them
+	template <class T>
+	Rot3<T> interpolate(T t, const Rot3<T>& a, const Rot3<T>& b) { return slerp(a, b, t); }
+
 	template <class A, class B>
 	auto rotation(const A& from, const B& to)
 	{
@@ -231,6 +315,14 @@ namespace uv
 		return Rot3<weak_double>::fromUnchecked(quaternion((*this/2).cos(), (*this/2).sin()*axis));
 	}
 
+	template <class V>
+	constexpr auto Anglef::about(const V& axis) const
+	{
+		float s = 0, c = 0;
+		sincos(*this/2, s, c);
+		return Rot3<float>::fromUnchecked(quaternion(c, s*axis));
+	}
+
 }
 
 #define UVECTOR_ROTATION_DEFINED
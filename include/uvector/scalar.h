@@ -6,6 +6,8 @@
 #include <cmath>
 #include <cassert>
 
+#include "../base/gsl.h"
+
 namespace uv
 {
 	using std::sin;
@@ -151,6 +153,8 @@ namespace uv
 
 		template <class T>
 		using if_arith_t = std::enable_if_t<std::is_arithmetic<T>::value>;
+
+		friend class Anglef;
 	public:
 
 		constexpr double _taylor_sin() const
@@ -243,6 +247,116 @@ namespace uv
 
 	static constexpr auto degrees = pi/180;
 
+	namespace details
+	{
+		// sin and cos of |r| <= pi/4 with the single precision minimax polynomials of Cephes sinf/cosf
+		constexpr void sincos_reduced(float r, float& s, float& c)
+		{
+			const float rr = r*r;
+			s = r + r*rr*(-1.6666654611e-1f + rr*(8.3321608736e-3f + rr*-1.9515295891e-4f));
+			c = 1 - 0.5f*rr + rr*rr*(4.166664568298827e-2f + rr*(-1.388731625493765e-3f + rr*2.443315711809948e-5f));
+		}
+
+		// Turns sin and cos of r into those of r + k*pi/2
+		constexpr void sincos_quadrant(int k, float& s, float& c)
+		{
+			const float sr = s, cr = c;
+			s = k & 1 ? cr : sr;
+			c = k & 1 ? sr : cr;
+			s = k & 2 ? -s : s;
+			c = (k + 1) & 2 ? -c : c;
+		}
+
+		// A single reduction to the nearest multiple of 90 degrees keeps the multiples of 30 and 45 degrees exact
+		constexpr void sincos_degrees(float p, float& s, float& c)
+		{
+			const float k = float(int(p*(1.f/90) + (p < 0 ? -0.5f : 0.5f)));
+			const float r = p - k*90;
+			sincos_reduced(r*0.0174532925199432957692f, s, c);
+			const float ar = r < 0 ? -r : r;
+			const float exact = ar == 30 ? 0.5f : 0.7071067811865475244f;
+			s = ar == 30 || ar == 45 ? (r < 0 ? -exact : exact) : s;
+			c = ar == 30 ? 0.8660254037844386468f : ar == 45 ? exact : c;
+			sincos_quadrant(int(k), s, c);
+		}
+
+		// Cody-Waite reduction by pi/2 split in three parts, accurate for |x| < 8192
+		constexpr void sincos_radians(float x, float& s, float& c)
+		{
+			const float k = float(int(x*0.636619772367581343f + (x < 0 ? -0.5f : 0.5f)));
+			const float r = ((x - k*1.5703125f) - k*4.837512969970703125e-4f) - k*7.54978995489188216e-8f;
+			sincos_reduced(r, s, c);
+			sincos_quadrant(int(k), s, c);
+		}
+	}
+
+	// Single precision counterpart of Angle, with sin and cos from one range reduction and a float polynomial
+	class Anglef
+	{
+		float _p;
+
+		explicit constexpr Anglef(float p) : _p(p) { }
+	public:
+		constexpr Anglef() : _p(180) { }
+		constexpr Anglef(Angle a) : _p(float(a._p)) { }
+
+		constexpr Anglef operator+() const { return Anglef(+_p); }
+		constexpr Anglef operator-() const { return Anglef(-_p); }
+
+		template <class T> constexpr friend Anglef operator*(Anglef p, T c) { return Anglef(p._p*c); }
+		template <class T> constexpr friend Anglef operator*(T c, Anglef p) { return Anglef(p._p*c); }
+		template <class T> constexpr friend Anglef operator/(Anglef p, T c) { return Anglef(p._p / c); }
+
+		constexpr friend Anglef operator+(Anglef a, Anglef b) { return Anglef(a._p + b._p); }
+		constexpr friend Anglef operator-(Anglef a, Anglef b) { return Anglef(a._p - b._p); }
+		constexpr friend float operator/(Anglef a, Anglef b) { return a._p / b._p; }
+
+		constexpr friend void sincos(Anglef a, float& s, float& c) { details::sincos_degrees(a._p, s, c); }
+
+		constexpr float sin() const { float s = 0, c = 0; sincos(*this, s, c); return s; }
+		constexpr float cos() const { float s = 0, c = 0; sincos(*this, s, c); return c; }
+
+		template <class V>
+		constexpr auto about(const V&) const;
+
+		constexpr operator float() const { return _p*0.0174532925199432957692f; }
+	};
+	template <>
+	struct is_scalar<Anglef> : std::true_type { };
+
+	constexpr float sin(Anglef a) { return a.sin(); }
+	constexpr float cos(Anglef a) { return a.cos(); }
+
+	// Sine and cosine of every element. The loops are free of branches and go through raw pointers, so that they
+	// compile to packed code (AVX when enabled).
+	inline void sincos(gsl::span<const Anglef> angles, gsl::span<float> s, gsl::span<float> c)
+	{
+		Expects(s.size() == angles.size() && c.size() == angles.size());
+		const Anglef* a = angles.data();
+		float* ps = s.data();
+		float* pc = c.data();
+		for (size_t i = 0; i < size_t(angles.size()); ++i)
+			sincos(a[i], ps[i], pc[i]);
+	}
+	inline void sincos(gsl::span<const Angle> angles, gsl::span<float> s, gsl::span<float> c)
+	{
+		Expects(s.size() == angles.size() && c.size() == angles.size());
+		const Angle* a = angles.data();
+		float* ps = s.data();
+		float* pc = c.data();
+		for (size_t i = 0; i < size_t(angles.size()); ++i)
+			sincos(Anglef(a[i]), ps[i], pc[i]);
+	}
+	inline void sincos(gsl::span<const float> radians, gsl::span<float> s, gsl::span<float> c)
+	{
+		Expects(s.size() == radians.size() && c.size() == radians.size());
+		const float* x = radians.data();
+		float* ps = s.data();
+		float* pc = c.data();
+		for (size_t i = 0; i < size_t(radians.size()); ++i)
+			details::sincos_radians(x[i], ps[i], pc[i]);
+	}
+
 	namespace details
 	{
 		template <class T, class = void>
@@ -0,0 +1,265 @@
+#pragma once
+
+#if !(defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#error "uvector/simd.h requires SSE2"
+#endif
+
+#include <immintrin.h>
+
+#include "vector.h"
+
+namespace uv
+{
+	// Explicitly vectorized 3- and 4-dimensional vectors, kept in a single SSE (float) or AVX (double) register.
+	// Three-dimensional vectors are padded to four lanes, with the fourth lane kept at zero.
+	namespace simd
+	{
+		template <class T>
+		struct Register;
+
+		template <>
+		struct Register<float>
+		{
+			using type = __m128;
+
+			static type set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+			static type broadcast(float s) { return _mm_set1_ps(s); }
+			static type load(const float* p) { return _mm_loadu_ps(p); }
+			static void store(float* p, type v) { _mm_storeu_ps(p, v); }
+
+			static type add(type a, type b) { return _mm_add_ps(a, b); }
+			static type sub(type a, type b) { return _mm_sub_ps(a, b); }
+			static type mul(type a, type b) { return _mm_mul_ps(a, b); }
+			static type div(type a, type b) { return _mm_div_ps(a, b); }
+			static type min(type a, type b) { return _mm_min_ps(a, b); }
+			static type max(type a, type b) { return _mm_max_ps(a, b); }
+			static type sqrt(type a) { return _mm_sqrt_ps(a); }
+
+			static type eq(type a, type b) { return _mm_cmpeq_ps(a, b); }
+			static type ne(type a, type b) { return _mm_cmpneq_ps(a, b); }
+			static type sl(type a, type b) { return _mm_cmplt_ps(a, b); }
+			static type le(type a, type b) { return _mm_cmple_ps(a, b); }
+
+			static type bit_and(type a, type b) { return _mm_and_ps(a, b); }
+			static type bit_andnot(type a, type b) { return _mm_andnot_ps(a, b); }
+			static type bit_or(type a, type b) { return _mm_or_ps(a, b); }
+			static type bit_xor(type a, type b) { return _mm_xor_ps(a, b); }
+			static int movemask(type a) { return _mm_movemask_ps(a); }
+
+			static type sign() { return _mm_set1_ps(-0.0f); }
+			static type xyz() { return _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)); }
+			static type all() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+
+			static type blend(type m, type a, type b)
+			{
+#ifdef __SSE4_1__
+				return _mm_blendv_ps(b, a, m);
+#else
+				return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+#endif
+			}
+			static type yzx(type v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 2, 1)); }
+			static float sum(type v)
+			{
+				const type shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+				const type sums = _mm_add_ps(v, shuf);
+				return _mm_cvtss_f32(_mm_add_ss(sums, _mm_movehl_ps(shuf, sums)));
+			}
+		};
+
+#ifdef __AVX__
+		template <>
+		struct Register<double>
+		{
+			using type = __m256d;
+
+			static type set(double x, double y, double z, double w) { return _mm256_setr_pd(x, y, z, w); }
+			static type broadcast(double s) { return _mm256_set1_pd(s); }
+			static type load(const double* p) { return _mm256_loadu_pd(p); }
+			static void store(double* p, type v) { _mm256_storeu_pd(p, v); }
+
+			static type add(type a, type b) { return _mm256_add_pd(a, b); }
+			static type sub(type a, type b) { return _mm256_sub_pd(a, b); }
+			static type mul(type a, type b) { return _mm256_mul_pd(a, b); }
+			static type div(type a, type b) { return _mm256_div_pd(a, b); }
+			static type min(type a, type b) { return _mm256_min_pd(a, b); }
+			static type max(type a, type b) { return _mm256_max_pd(a, b); }
+			static type sqrt(type a) { return _mm256_sqrt_pd(a); }
+
+			static type eq(type a, type b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+			static type ne(type a, type b) { return _mm256_cmp_pd(a, b, _CMP_NEQ_UQ); }
+			static type sl(type a, type b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+			static type le(type a, type b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+
+			static type bit_and(type a, type b) { return _mm256_and_pd(a, b); }
+			static type bit_andnot(type a, type b) { return _mm256_andnot_pd(a, b); }
+			static type bit_or(type a, type b) { return _mm256_or_pd(a, b); }
+			static type bit_xor(type a, type b) { return _mm256_xor_pd(a, b); }
+			static int movemask(type a) { return _mm256_movemask_pd(a); }
+
+			static type sign() { return _mm256_set1_pd(-0.0); }
+			static type xyz() { return _mm256_castsi256_pd(_mm256_setr_epi64x(-1, -1, -1, 0)); }
+			static type all() { return _mm256_castsi256_pd(_mm256_set1_epi64x(-1)); }
+
+			static type blend(type m, type a, type b) { return _mm256_blendv_pd(b, a, m); }
+			static type yzx(type v)
+			{
+#ifdef __AVX2__
+				return _mm256_permute4x64_pd(v, _MM_SHUFFLE(3, 0, 2, 1));
+#else
+				// (y, x, w, z) and (z, w, x, y) interleave to (y, z, w, x); then swap the upper pair
+				const type swapped = _mm256_permute_pd(v, 0b0101);
+				const type rotated = _mm256_permute2f128_pd(v, v, 0x01);
+				return _mm256_permute_pd(_mm256_unpacklo_pd(swapped, rotated), 0b0110);
+#endif
+			}
+			static double sum(type v)
+			{
+				const __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+				return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+			}
+		};
+#endif
+
+		template <class T, size_t N>
+		class Mask
+		{
+			static_assert(N == 3 || N == 4, "SIMD masks have three or four lanes");
+			using R = Register<T>;
+			static constexpr int bits = (1 << N) - 1;
+
+			typename R::type _m;
+		public:
+			using register_type = typename R::type;
+
+			explicit Mask(register_type m) : _m(m) { }
+
+			register_type native() const { return _m; }
+			int bitmask() const { return R::movemask(_m) & bits; }
+
+			bool operator[](size_t i) const { return (bitmask() >> i) & 1; }
+
+			friend bool any(Mask m) { return m.bitmask() != 0; }
+			friend bool all(Mask m) { return m.bitmask() == bits; }
+
+			friend Mask operator&(Mask a, Mask b) { return Mask{ R::bit_and(a._m, b._m) }; }
+			friend Mask operator|(Mask a, Mask b) { return Mask{ R::bit_or(a._m, b._m) }; }
+			Mask operator!() const { return Mask{ R::bit_xor(_m, R::all()) }; }
+
+			explicit operator bool() const { return all(*this); }
+
+			operator Vec<bool, N>() const { Vec<bool, N> r; for (size_t i = 0; i < N; ++i) r[i] = (*this)[i]; return r; }
+		};
+
+		template <class T, size_t N>
+		class Packed
+		{
+			static_assert(N == 3 || N == 4, "SIMD vectors have three or four lanes");
+			using R = Register<T>;
+
+			typename R::type _v;
+
+			static typename R::type _clean(typename R::type v) { if constexpr (N == 3) return R::bit_and(v, R::xyz()); else return v; }
+		public:
+			using register_type = typename R::type;
+			using scalar_type = T;
+			static constexpr size_t dim = N;
+
+			Packed() { }
+			explicit Packed(register_type v) : _v(v) { }
+			Packed(T s) : _v(N == 4 ? R::broadcast(s) : R::set(s, s, s, T(0))) { }
+			template <size_t M = N, class = std::enable_if_t<M == 3>>
+			Packed(T x, T y, T z) : _v(R::set(x, y, z, T(0))) { }
+			template <size_t M = N, class = std::enable_if_t<M == 4>>
+			Packed(T x, T y, T z, T w) : _v(R::set(x, y, z, w)) { }
+			template <int K>
+			Packed(const Vec<T, N, K>& v)
+			{
+				if constexpr (N == 4 && K == 1)
+					_v = R::load(&v[0]);
+				else
+					_v = R::set(v[0], v[1], v[2], N == 4 ? v[N - 1] : T(0));
+			}
+
+			operator Vec<T, N>() const
+			{
+				if constexpr (N == 4)
+				{
+					Vec<T, N> r;
+					R::store(&r[0], _v);
+					return r;
+				}
+				else
+				{
+					T a[4];
+					R::store(a, _v);
+					return { a[0], a[1], a[2] };
+				}
+			}
+
+			register_type native() const { return _v; }
+
+			T operator[](size_t i) const { T a[4]; R::store(a, _v); return a[i]; }
+
+			Packed operator+() const { return *this; }
+			Packed operator-() const { return Packed{ R::bit_xor(_v, R::sign()) }; }
+
+			friend Packed operator+(Packed a, Packed b) { return Packed{ R::add(a._v, b._v) }; }
+			friend Packed operator-(Packed a, Packed b) { return Packed{ R::sub(a._v, b._v) }; }
+			friend Packed operator*(Packed a, Packed b) { return Packed{ R::mul(a._v, b._v) }; }
+			friend Packed operator/(Packed a, Packed b) { return Packed{ _clean(R::div(a._v, b._v)) }; }
+
+			Packed& operator+=(Packed b) { _v = R::add(_v, b._v); return *this; }
+			Packed& operator-=(Packed b) { _v = R::sub(_v, b._v); return *this; }
+			Packed& operator*=(Packed b) { _v = R::mul(_v, b._v); return *this; }
+			Packed& operator/=(Packed b) { _v = _clean(R::div(_v, b._v)); return *this; }
+
+			friend Mask<T, N> operator==(Packed a, Packed b) { return Mask<T, N>{ R::eq(a._v, b._v) }; }
+			friend Mask<T, N> operator!=(Packed a, Packed b) { return Mask<T, N>{ R::ne(a._v, b._v) }; }
+			friend Mask<T, N> operator< (Packed a, Packed b) { return Mask<T, N>{ R::sl(a._v, b._v) }; }
+			friend Mask<T, N> operator<=(Packed a, Packed b) { return Mask<T, N>{ R::le(a._v, b._v) }; }
+			friend Mask<T, N> operator> (Packed a, Packed b) { return Mask<T, N>{ R::sl(b._v, a._v) }; }
+			friend Mask<T, N> operator>=(Packed a, Packed b) { return Mask<T, N>{ R::le(b._v, a._v) }; }
+
+			friend Packed min(Packed a, Packed b) { return Packed{ R::min(a._v, b._v) }; }
+			friend Packed max(Packed a, Packed b) { return Packed{ R::max(a._v, b._v) }; }
+			friend Packed abs(Packed a) { return Packed{ R::bit_andnot(R::sign(), a._v) }; }
+			friend Packed ifelse(Mask<T, N> m, Packed a, Packed b) { return Packed{ R::blend(m.native(), a._v, b._v) }; }
+
+			friend T sum(Packed a) { return R::sum(a._v); }
+			friend T dot(Packed a, Packed b) { return R::sum(R::mul(a._v, b._v)); }
+			friend T square(Packed a) { return dot(a, a); }
+			friend T length(Packed a) { return std::sqrt(square(a)); }
+
+			friend Packed cross(Packed a, Packed b)
+			{
+				static_assert(N == 3, "Cross product only defined for three-dimensional SIMD vectors");
+				// a x b = yzx(a * yzx(b) - yzx(a) * b)
+				return Packed{ R::yzx(R::sub(R::mul(a._v, R::yzx(b._v)), R::mul(R::yzx(a._v), b._v))) };
+			}
+		};
+
+		using float3 = Packed<float, 3>;
+		using float4 = Packed<float, 4>;
+		using bool3 = Mask<float, 3>;
+		using bool4 = Mask<float, 4>;
+#ifdef __AVX__
+		using double3 = Packed<double, 3>;
+		using double4 = Packed<double, 4>;
+		using bool3d = Mask<double, 3>;
+		using bool4d = Mask<double, 4>;
+#endif
+	}
+
+	namespace details
+	{
+		template <class T, size_t N>
+		struct Scalar<simd::Packed<T, N>> { using type = T; };
+	}
+}
+
+#define UVECTOR_SIMD_DEFINED
+
+#ifdef UVECTOR_MATRIX_DEFINED
+#include "cross/matrix_simd.h"
+#endif
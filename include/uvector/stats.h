@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+
+#include "bounds.h"
+#include "matrix.h"
+#include "point.h"
+
+namespace uv
+{
+	// Count, mean, bounds and covariance of a stream of points, updated one point at a time with Welford's method
+	// or a batch at a time, and merged with the pairwise update of Chan, Golub and LeVeque, so partial results
+	// from separate threads or files combine in constant time without losing precision.
+	template <class T, size_t N>
+	class PointStats
+	{
+		using U = type::identity<T>;
+		using M = type::mul<T>;
+
+		size_t _count = 0;
+		Vec<T, N> _mean;
+		Mat<M, N, N> _m2 = M(0); // sum of the outer products of the deviations from the mean
+		Vec<Bounds<T>, N> _bounds;
+
+		static constexpr size_t _block = 64;
+		static constexpr size_t _lanes = 8;
+
+		// Sums f(i) over the block in separate lanes, which unlike a single accumulator does not forbid vectorization
+		template <class S, class F>
+		static S _sum(F f)
+		{
+			S acc[_lanes];
+			std::fill(acc, acc + _lanes, S(0));
+			for (size_t i = 0; i < _block; i += _lanes)
+				for (size_t j = 0; j < _lanes; ++j)
+					acc[j] = acc[j] + f(i + j);
+			S s = S(0);
+			for (size_t j = 0; j < _lanes; ++j)
+				s = s + acc[j];
+			return s;
+		}
+
+		// Two passes over up to _block points in structure-of-arrays form, zero padded: the mean, then the deviations from it
+		void _add_block(const T* x, size_t n)
+		{
+			PointStats block;
+			block._count = n;
+			T lanes[N][_block];
+			for (size_t k = 0; k < N; ++k)
+				std::fill(lanes[k] + n, lanes[k] + _block, T(0));
+			for (size_t i = 0; i < n; ++i)
+				for (size_t k = 0; k < N; ++k)
+				{
+					const T v = x[i*N + k];
+					lanes[k][i] = v;
+					block._bounds[k].min = v < block._bounds[k].min ? v : block._bounds[k].min;
+					block._bounds[k].max = block._bounds[k].max < v ? v : block._bounds[k].max;
+				}
+			for (size_t k = 0; k < N; ++k)
+			{
+				T* l = lanes[k];
+				const T m = _sum<T>([l](size_t i) { return l[i]; }) / U(n);
+				block._mean[k] = m;
+				for (size_t i = 0; i < _block; ++i)
+					l[i] = i < n ? l[i] - m : T(0);
+			}
+			for (size_t r = 0; r < N; ++r)
+				for (size_t c = r; c < N; ++c)
+				{
+					const T* a = lanes[r];
+					const T* b = lanes[c];
+					rows(block._m2)[r][c] = rows(block._m2)[c][r] = _sum<M>([a, b](size_t i) { return a[i]*b[i]; });
+				}
+			merge(block);
+		}
+		void _add_batch(const T* x, size_t n)
+		{
+			for (size_t first = 0; first < n; first += _block)
+				_add_block(x + first*N, std::min(_block, n - first));
+		}
+	public:
+		PointStats() : _mean(T(0)) { for (size_t k = 0; k < N; ++k) _bounds[k] = empty; }
+
+		void add(const Vec<T, N>& x)
+		{
+			++_count;
+			const Vec<T, N> d = x - _mean;
+			_mean = _mean + d / U(_count);
+			// d*(x - new mean) written symmetrically, the upper triangle mirrored so contractions cannot break the symmetry
+			const U f = U(_count - 1) / U(_count);
+			for (size_t r = 0; r < N; ++r)
+				for (size_t c = r; c < N; ++c)
+					rows(_m2)[r][c] = rows(_m2)[c][r] = rows(_m2)[r][c] + d[r]*d[c]*f;
+			for (size_t k = 0; k < N; ++k)
+			{
+				_bounds[k].min = x[k] < _bounds[k].min ? x[k] : _bounds[k].min;
+				_bounds[k].max = _bounds[k].max < x[k] ? x[k] : _bounds[k].max;
+			}
+		}
+		void add(const Point<T, N>& p) { add(p.v); }
+
+		// Batches are taken in blocks of consecutive points, each reduced over contiguous lanes that vectorize
+		void add(gsl::span<const Vec<T, N>> batch)
+		{
+			static_assert(sizeof(Vec<T, N>) == N*sizeof(T), "vectors must be packed");
+			if (!batch.empty())
+				_add_batch(&batch[0][0], size_t(batch.size()));
+		}
+		void add(gsl::span<const Point<T, N>> batch)
+		{
+			static_assert(sizeof(Point<T, N>) == N*sizeof(T), "points must be packed");
+			if (!batch.empty())
+				_add_batch(&batch[0].v[0], size_t(batch.size()));
+		}
+
+		void merge(const PointStats& b)
+		{
+			if (b._count == 0)
+				return;
+			if (_count == 0)
+			{
+				*this = b;
+				return;
+			}
+			const size_t n = _count + b._count;
+			const Vec<T, N> d = b._mean - _mean;
+			const U f = U(_count) * U(b._count) / U(n);
+			for (size_t r = 0; r < N; ++r)
+				for (size_t c = r; c < N; ++c)
+					rows(_m2)[r][c] = rows(_m2)[c][r] = rows(_m2)[r][c] + rows(b._m2)[r][c] + d[r]*d[c]*f;
+			_mean = _mean + d * (U(b._count) / U(n));
+			for (size_t k = 0; k < N; ++k)
+				_bounds[k] = uv::bounds(_bounds[k], b._bounds[k]);
+			_count = n;
+		}
+
+		size_t count() const { return _count; }
+		Point<T, N> mean() const { return point(_mean); }
+		const Vec<Bounds<T>, N>& bounds() const { return _bounds; }
+		// Population covariance, dividing by count(); scale by count()/(count() - 1) for the unbiased sample estimate
+		Mat<M, N, N> covariance() const { return _count == 0 ? Mat<M, N, N>(M(0)) : _m2 * (U(1) / U(_count)); }
+	};
+
+	template <class T> using PointStats2 = PointStats<T, 2>;
+	template <class T> using PointStats3 = PointStats<T, 3>;
+}
+
+#define UVECTOR_STATS_DEFINED
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "vector.h"
+#include "rotation.h"
+
+namespace uv
+{
+	// Keyframed rotation tracks, for skeletal animation, sampled with fast_slerp between the keys around each time
+	// and held at the first and last keys outside them. All the tracks share one array of keys, and each keeps a
+	// cursor on the key it was last sampled at, so monotonic sampling, the usual case, steps at most a key forward
+	// instead of searching. Sampling every track at once does the cursor updates and gathers the keys first, then
+	// the interpolations a block at a time over contiguous lanes that vectorize.
+	template <class T>
+	class RotationTracks
+	{
+		static constexpr size_t _block = 64;
+
+		std::vector<T> _times;
+		std::vector<Quat<T>> _keys; // of every track one after the other, so a segment is read from at most two cache lines
+		std::vector<size_t> _first = { 0 }; // the keys of track i are [_first[i], _first[i + 1])
+		std::vector<size_t> _cursor; // the key at or before the last time sampled on each track
+
+		// The key starting the segment containing 'time' on a track, moving its cursor there, and the parameter within the segment
+		size_t _seek(size_t track, T time, T& t)
+		{
+			const size_t first = _first[track], last = _first[track + 1] - 1;
+			size_t c = _cursor[track];
+			if (time < _times[c])
+			{
+				// the last key at or before 'time', or the first key when 'time' is before all of them
+				const size_t u = size_t(std::upper_bound(_times.begin() + first, _times.begin() + last + 1, time) - _times.begin());
+				c = u > first ? u - 1 : first;
+			}
+			while (c < last && !(time < _times[c + 1]))
+				++c;
+			_cursor[track] = c;
+			const size_t next = std::min(c + 1, last);
+			const T span = _times[next] - _times[c];
+			const T u = span > T(0) ? (time - _times[c]) / span : T(0);
+			t = u < T(0) ? T(0) : (T(1) < u ? T(1) : u);
+			return c;
+		}
+		size_t _next(size_t track, size_t key) const { return std::min(key + 1, _first[track + 1] - 1); }
+
+	public:
+		// Adds a track with keys at strictly increasing times, returning its index
+		size_t add(gsl::span<const T> times, gsl::span<const Rot3<T>> keys)
+		{
+			Expects(!times.empty() && times.size() == keys.size());
+			for (size_t i = 0; i < size_t(times.size()); ++i)
+			{
+				Expects(i == 0 || times[i - 1] < times[i]);
+				const Quat<T>& q = quaternion(keys[i]);
+				_times.push_back(times[i]);
+				_keys.push_back(q);
+			}
+			_cursor.push_back(_first.back());
+			_first.push_back(_times.size());
+			return _cursor.size() - 1;
+		}
+
+		// The number of tracks
+		size_t size() const { return _cursor.size(); }
+		size_t keys(size_t track) const { return _first[track + 1] - _first[track]; }
+
+		Rot3<T> sample(size_t track, T time)
+		{
+			T t;
+			const size_t a = _seek(track, time, t), b = _next(track, a);
+			return fast_slerp(Rot3<T>::fromUnchecked(_keys[a]), Rot3<T>::fromUnchecked(_keys[b]), t);
+		}
+
+		// Samples every track at the same time, writing track i to result[i]
+		void sample(T time, gsl::span<Rot3<T>> result)
+		{
+			Expects(size_t(result.size()) == size());
+			T a[4][_block], b[4][_block], r[4][_block], t[_block];
+			for (size_t first = 0; first < size(); first += _block)
+			{
+				const size_t n = std::min(_block, size() - first);
+				for (size_t j = 0; j < n; ++j)
+				{
+					const size_t ka = _seek(first + j, time, t[j]), kb = _next(first + j, ka);
+					a[0][j] = _keys[ka].re;
+					b[0][j] = _keys[kb].re;
+					for (size_t k = 0; k < 3; ++k)
+					{
+						a[k + 1][j] = _keys[ka].im[k];
+						b[k + 1][j] = _keys[kb].im[k];
+					}
+				}
+				// details::fast_slerp written out over the lanes, as a call per lane keeps the loop from vectorizing
+				for (size_t j = 0; j < n; ++j)
+				{
+					const T d = a[0][j]*b[0][j] + a[1][j]*b[1][j] + a[2][j]*b[2][j] + a[3][j]*b[3][j];
+					const T sign = d < T(0) ? T(-1) : T(1);
+					const T x = d*sign - T(1);
+					const T u = t[j], s = T(1) - u;
+					T ct = T(1), cs = T(1);
+					for (size_t i = 8; i-- > 0;)
+					{
+						ct = T(1) + (T(details::slerp_u(i))*u*u - T(details::slerp_v(i)))*x*ct;
+						cs = T(1) + (T(details::slerp_u(i))*s*s - T(details::slerp_v(i)))*x*cs;
+					}
+					const T wa = s*cs, wb = sign*u*ct;
+					for (size_t k = 0; k < 4; ++k)
+						r[k][j] = a[k][j]*wa + b[k][j]*wb;
+				}
+				for (size_t j = 0; j < n; ++j)
+					result[first + j] = Rot3<T>::fromUnchecked(quaternion(r[0][j], vector(r[1][j], r[2][j], r[3][j])));
+			}
+		}
+	};
+
+	using RotationTracksf = RotationTracks<float>;
+	using RotationTracksd = RotationTracks<double>;
+}
+
+#define UVECTOR_TRACK_DEFINED
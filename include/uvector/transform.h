@@ -52,6 +52,44 @@ namespace uv
 	using Transform3f = Trans3<float>;
 	using Transform3d = Trans3<double>;
 
+	// A similarity transform, x -> s*(r*x) + t: a rigid motion with a uniform scale, which keeps scaled nodes off 4x4
+	// matrices. Applying it costs a rotation and one scale per vector, and its inverse is in closed form.
+	template <class T>
+	class Sim3
+	{
+		using U = type::identity<T>;
+	public:
+		Rot3<U> r;
+		U s;
+		Vec3<T> t;
+
+		Sim3() = delete;
+		Sim3(Identity I) : r(I), s(1), t(T(0)) { }
+		template <class B>
+		Sim3(const Trans3<B>& tf) : r(tf.r), s(1), t(tf.t) { }
+		template <class W, class V, class = if_vector_t<3, V>>
+		Sim3(const Rot3<W>& r, U s, const V& t) : r(r), s(s), t(t) { }
+
+		template <class B>
+		friend Sim3<type::add<T, B>> operator*(const Sim3& a, const Sim3<B>& b) { return { a.r*b.r, a.s*b.s, a.t + (a.r*b.t)*a.s }; }
+		template <class B> friend Sim3<type::add<T, B>> operator*(const Sim3& a, const Trans3<B>& b) { return a * Sim3<B>(b); }
+		template <class B> friend Sim3<type::add<T, B>> operator*(const Trans3<B>& a, const Sim3& b) { return Sim3<B>(a) * b; }
+		template <class V, class = if_vector_t<3, V>> friend auto operator*(const Sim3& tf, const V& v) { return (tf.r * v) * tf.s; }
+		template <class B>           friend Point3<type::add<T, B>> operator*(const Sim3& tf, const Point3<B>&    p) { return point((tf.r * p.v) * tf.s + tf.t); }
+
+		Sim3& operator*=(const Sim3& b) { *this = *this * b; return *this; }
+
+		friend Sim3 invert(Sim3 tf)
+		{
+			tf.r = invert(tf.r);
+			tf.s = U(1) / tf.s;
+			tf.t = -(tf.r*tf.t)*tf.s;
+			return tf;
+		}
+	};
+	using Sim3f = Sim3<float>;
+	using Sim3d = Sim3<double>;
+
 }
 
 #define UVECTOR_TRANSFORM_DEFINED
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
+#include <functional>
 #include <iterator>
 #include <ostream>
 
@@ -74,6 +76,18 @@ namespace uv
 		template <class T>
 		static constexpr bool always_false = false;
 
+		template <class V>
+		class LazyVec;
+		template <class OP, class A, class B>
+		class LazyOp;
+
+		template <class T> struct is_lazy : std::false_type { };
+		template <class T> struct is_lazy<T&> : is_lazy<T> { };
+		template <class T> struct is_lazy<const T> : is_lazy<T> { };
+		template <class V> struct is_lazy<LazyVec<V>> : std::true_type { };
+		template <class OP, class A, class B> struct is_lazy<LazyOp<OP, A, B>> : std::true_type { };
+		template <class T>
+		static constexpr bool is_lazy_v = is_lazy<T>::value;
 	}
 
 
@@ -523,6 +537,50 @@ namespace uv
 		template <class OP, class A, class B, class = std::enable_if_t<!is_scalar_v<OP>>>
 		constexpr Vec(OP&& op, const A& a, const B& b) : _data(op, a, b) { }
 
+		// Whether the lazy expression 's' reads any element of this vector
+		template <class S>
+		bool _read_by(const S& s) const
+		{
+			const void* lo = &(*this)[0];
+			const void* hi = lo;
+			for (size_t i = 1; i < N; ++i)
+			{
+				lo = std::less<const void*>{}(&(*this)[i], lo) ? &(*this)[i] : lo;
+				hi = std::less<const void*>{}(hi, &(*this)[i]) ? &(*this)[i] : hi;
+			}
+			return s.overlaps(lo, hi);
+		}
+
+		template <class OP, class S>
+		Vec& _assign(const S& s)
+		{
+			// Scalars and lazy expressions are applied in place, anything else goes through a temporary
+			if constexpr (is_scalar_v<S>)
+			{
+				OP op;
+				for (size_t i = 0; i < N; ++i)
+					(*this)[i] = op((*this)[i], s);
+			}
+			else if constexpr (details::is_lazy_v<S>)
+			{
+				// unless the expression reads this vector, as in v[XY] += lazy(v[YZ]), where the elements written first
+				// would be read after; then it is evaluated before anything is written
+				OP op;
+				if (_read_by(s))
+				{
+					const Vec<scalar<S>, N> e = s;
+					for (size_t i = 0; i < N; ++i)
+						(*this)[i] = op((*this)[i], e[i]);
+				}
+				else
+					for (size_t i = 0; i < N; ++i)
+						(*this)[i] = op((*this)[i], s[i]);
+			}
+			else
+				*this = OP{}(*this, s);
+			return *this;
+		}
+
 		template <class S>
 		struct conversion_checker
 		{
@@ -544,7 +602,19 @@ namespace uv
 		constexpr Vec& operator=(const Vec&) = default;
 
 		template <class S, class = std::enable_if_t<is_scalar_v<S> || is_vector_v<N, S>>>
-		constexpr Vec& operator=(const S& s) { conversion_checker<const S&>{}; _data = s; return *this; }
+		constexpr Vec& operator=(const S& s)
+		{
+			conversion_checker<const S&>{};
+			// a lazy expression reading this vector, as in v[YW] = lazy(v[XY]), is evaluated before anything is written
+			if constexpr (details::is_lazy_v<S>)
+				if (_read_by(s))
+				{
+					_data = Vec<scalar<S>, N>(s);
+					return *this;
+				}
+			_data = s;
+			return *this;
+		}
 
 		auto begin()       { return _data.begin(); }
 		auto begin() const { return _data.begin(); }
@@ -618,10 +688,10 @@ namespace uv
 		template <class V, class = if_vector_t<N, V>> Vec<bool, N> operator==(const V& v) const { return _apply<op::eq>(v); }
 		template <class V, class = if_vector_t<N, V>> Vec<bool, N> operator< (const V& v) const { return _apply<op::sl>(v); }
 
-		template <class S> Vec& operator+=(const S& v) { *this = *this + v; return *this; }
-		template <class S> Vec& operator-=(const S& v) { *this = *this - v; return *this; }
-		template <class S> Vec& operator*=(const S& v) { *this = *this * v; return *this; }
-		template <class S> Vec& operator/=(const S& v) { *this = *this / v; return *this; }
+		template <class S> Vec& operator+=(const S& v) { return _assign<op::add>(v); }
+		template <class S> Vec& operator-=(const S& v) { return _assign<op::sub>(v); }
+		template <class S> Vec& operator*=(const S& v) { return _assign<op::mul>(v); }
+		template <class S> Vec& operator/=(const S& v) { return _assign<op::div>(v); }
 
 		explicit constexpr operator bool() const { return bool(_data); }
 
@@ -914,6 +984,111 @@ namespace uv
 	details::ToProject<V> project(const V& v) { return { v }; }
 
 
+	namespace details
+	{
+		template <class T> struct LazyOperand { using type = T; };
+		template <class T, size_t N, int K> struct LazyOperand<Vec<T, N, K>> { using type = const Vec<T, N, K>&; };
+		template <class T, size_t N> struct LazyOperand<Dir<T, N>> { using type = const Dir<T, N>&; };
+
+		template <class T> struct is_lazy_operand : std::bool_constant<is_scalar_v<T> || is_lazy_v<T>> { };
+		template <class T, size_t N, int K> struct is_lazy_operand<Vec<T, N, K>> : std::true_type { };
+		template <class T, size_t N> struct is_lazy_operand<Dir<T, N>> : std::true_type { };
+
+		// Whether an operand of a lazy expression reads any element stored in [lo, hi]
+		template <class S>
+		constexpr std::enable_if_t<is_scalar_v<S>, bool> overlaps(const S&, const void*, const void*) { return false; }
+		template <class T, size_t N, int K>
+		bool overlaps(const Vec<T, N, K>& v, const void* lo, const void* hi)
+		{
+			const std::less<const void*> less;
+			for (size_t i = 0; i < N; ++i)
+				if (!less(&v[i], lo) && !less(hi, &v[i]))
+					return true;
+			return false;
+		}
+		template <class E>
+		std::enable_if_t<is_lazy_v<E>, bool> overlaps(const E& e, const void* lo, const void* hi) { return e.overlaps(lo, hi); }
+
+		// Leaf of a lazy vector expression, refers to the vector it was created from
+		template <class V>
+		class LazyVec
+		{
+			const V& _v;
+		public:
+			static constexpr size_t dim = V::dim;
+
+			explicit constexpr LazyVec(const V& v) : _v(v) { }
+
+			constexpr const scalar<V>& operator[](size_t i) const { return _v[i]; }
+			bool overlaps(const void* lo, const void* hi) const { return details::overlaps(_v, lo, hi); }
+		};
+
+		// Node of a lazy vector expression; elements are computed when read, so nothing is stored in between.
+		// Vector operands are held by reference and must outlive the expression.
+		template <class OP, class A, class B>
+		class LazyOp
+		{
+			typename LazyOperand<A>::type _a;
+			typename LazyOperand<B>::type _b;
+		public:
+			static constexpr size_t dim = std::max(Dim<A>::value, Dim<B>::value);
+			static_assert(Dim<A>::value == dim || is_scalar_v<A>, "Vector-vector operation requires equal dimensionality");
+			static_assert(Dim<B>::value == dim || is_scalar_v<B>, "Vector-vector operation requires equal dimensionality");
+
+			constexpr LazyOp(const A& a, const B& b) : _a(a), _b(b) { }
+
+			constexpr auto operator[](size_t i) const { return OP{}(Element(i).of(_a), Element(i).of(_b)); }
+			bool overlaps(const void* lo, const void* hi) const { return details::overlaps(_a, lo, hi) || details::overlaps(_b, lo, hi); }
+		};
+
+		template <class V>
+		struct Scalar<LazyVec<V>> { using type = scalar<V>; };
+		template <class OP, class A, class B>
+		struct Scalar<LazyOp<OP, A, B>> { using type = uv::type::of<OP, scalar<A>, scalar<B>>; };
+	}
+	template <size_t N, class V> struct is_vector<N, details::LazyVec<V>> : std::bool_constant<N == V::dim> { };
+	template <size_t N, class OP, class A, class B> struct is_vector<N, details::LazyOp<OP, A, B>> : std::bool_constant<N == details::LazyOp<OP, A, B>::dim> { };
+
+	template <class A, class B, class R = void>
+	using if_lazy_t = std::enable_if_t<(details::is_lazy_v<A> || details::is_lazy_v<B>) && details::is_lazy_operand<A>::value && details::is_lazy_operand<B>::value, R>;
+
+	// Starts a lazy expression; arithmetic involving the result builds expression nodes instead of vectors,
+	// which are evaluated in a single pass on assignment to a Vec, by eval or by sum, dot and square
+	template <class T, size_t N, int K> constexpr details::LazyVec<Vec<T, N, K>> lazy(const Vec<T, N, K>& v) { return details::LazyVec<Vec<T, N, K>>{ v }; }
+	template <class T, size_t N> constexpr details::LazyVec<Dir<T, N>> lazy(const Dir<T, N>& d) { return details::LazyVec<Dir<T, N>>{ d }; }
+
+	template <class E, class = if_lazy_t<E, E>> constexpr Vec<scalar<E>, dim<E>> eval(const E& e) { return e; }
+
+	template <class A, class B, class = if_lazy_t<A, B>> constexpr details::LazyOp<op::add, A, B> operator+(const A& a, const B& b) { return { a, b }; }
+	template <class A, class B, class = if_lazy_t<A, B>> constexpr details::LazyOp<op::sub, A, B> operator-(const A& a, const B& b) { return { a, b }; }
+	template <class A, class B, class = if_lazy_t<A, B>> constexpr details::LazyOp<op::mul, A, B> operator*(const A& a, const B& b) { return { a, b }; }
+	template <class A, class B, class = if_lazy_t<A, B>> constexpr details::LazyOp<op::div, A, B> operator/(const A& a, const B& b) { return { a, b }; }
+	template <class A, class = if_lazy_t<A, A>> constexpr details::LazyOp<op::sub, scalar<A>, A> operator-(const A& a) { return { scalar<A>(0), a }; }
+
+	template <class E, class = if_lazy_t<E, E>>
+	constexpr scalar<E> sum(const E& e)
+	{
+		scalar<E> s = e[0];
+		for (size_t i = 1; i < dim<E>; ++i)
+			s = s + e[i];
+		return s;
+	}
+	template <class A, class B, class = if_lazy_t<A, B>>
+	constexpr auto dot(const A& a, const B& b) { return sum(details::LazyOp<op::mul, A, B>{ a, b }); }
+	template <class E, class = if_lazy_t<E, E>>
+	constexpr auto square(const E& e)
+	{
+		auto x = e[0];
+		auto s = x*x;
+		for (size_t i = 1; i < dim<E>; ++i)
+		{
+			x = e[i];
+			s = s + x*x;
+		}
+		return s;
+	}
+
+
 	template <size_t N, int K>
 	constexpr size_t index(const Vec<bool, N, K>& v)
 	{
@@ -1028,6 +1203,27 @@ namespace std
 	{
 		using type = uv::Vec<common_type_t<A, B>, N>;
 	};
+
+	// Combines the component hashes with a multiplicative mix and finishes with a xor-shift-multiply round, so that all the bits
+	// depend on all the components: std::hash of an integer is often the integer itself, and tables keep only the low bits
+	template <class T, size_t N, int K>
+	struct hash<uv::Vec<T, N, K>>
+	{
+		size_t operator()(const uv::Vec<T, N, K>& v) const noexcept
+		{
+			uint64_t h = 0;
+			for (size_t i = 0; i < N; ++i)
+				h = (h ^ uint64_t(hash<T>()(v[i]))) * 0x9e3779b97f4a7c15ull;
+			h = (h ^ (h >> 32)) * 0xd6e8feb86659fd93ull;
+			return size_t(h ^ (h >> 32));
+		}
+	};
+	// Vec == Vec compares component by component, so containers need this to get a single bool
+	template <class T, size_t N, int K>
+	struct equal_to<uv::Vec<T, N, K>>
+	{
+		bool operator()(const uv::Vec<T, N, K>& a, const uv::Vec<T, N, K>& b) const { return all(a == b); }
+	};
 }
 
 #define UVECTOR_VECTOR_DEFINED
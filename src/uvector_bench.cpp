@@ -0,0 +1,857 @@
+#include <uvector/vector.h>
+#include <uvector/matrix.h>
+#include <uvector/transform.h>
+#include <uvector/bounds.h>
+#include <uvector/complex.h>
+#include <uvector/ray.h>
+#include <uvector/frustum.h>
+#include <uvector/reduce.h>
+#include <uvector/stats.h>
+#include <uvector/morton.h>
+#include <uvector/kdtree.h>
+#include <uvector/hashgrid.h>
+#include <uvector/aabbtree.h>
+#include <uvector/octree.h>
+#include <uvector/track.h>
+#include <uvector/dualquat.h>
+#include <uvector/lie.h>
+#include <uvector/hierarchy.h>
+#include <uvector/bvh.h>
+#include <units.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Micro-benchmarks for the core operations. Results go to stdout as tab-separated lines,
+//   header  operation  scalar  mode  ns_per_op  gflops
+// where mode is 'latency' (every operation waits for the previous result) or 'throughput' (independent
+// operations over a batch). Flop counts are nominal, one per add, multiply, divide or sqrt.
+
+namespace
+{
+	std::mt19937 rng;
+
+	constexpr size_t chain_length = 1 << 14;
+	constexpr size_t batch_size = 1 << 12;
+
+	// Makes the compiler assume 'value' is read, so the work producing it cannot be dropped
+	template <class T>
+	void keep(const T& value)
+	{
+#if defined(__GNUC__)
+		asm volatile("" : : "r"(&value) : "memory");
+#else
+		static const void* volatile sink;
+		sink = &value;
+#endif
+	}
+
+	// Best of several runs, in nanoseconds per operation
+	template <class F>
+	double time_per_op(size_t ops, F&& f)
+	{
+		double best = 1e300;
+		for (int run = 0; run < 7; ++run)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			f();
+			const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+			best = std::min(best, elapsed.count() / ops);
+		}
+		return best;
+	}
+
+	void report(const char* header, const char* op, const char* scalar, const char* mode, double ns, double flops)
+	{
+		std::printf("%s\t%s\t%s\t%s\t%.3f\t%.3f\n", header, op, scalar, mode, ns, flops / ns);
+	}
+
+	template <class V, class F>
+	void latency(const char* header, const char* op, const char* scalar, double flops, V x, F f)
+	{
+		const double ns = time_per_op(chain_length, [&]
+		{
+			for (size_t i = 0; i < chain_length; ++i)
+				x = f(x);
+			keep(x);
+		});
+		report(header, op, scalar, "latency", ns, flops);
+	}
+
+	template <class In, class F>
+	void throughput(const char* header, const char* op, const char* scalar, double flops, const std::vector<In>& in, F f)
+	{
+		std::vector<decltype(f(in[0]))> out(in.size(), f(in[0]));
+		const double ns = time_per_op(in.size(), [&]
+		{
+			for (size_t i = 0; i < in.size(); ++i)
+				out[i] = f(in[i]);
+			keep(out[0]);
+		});
+		report(header, op, scalar, "throughput", ns, flops);
+	}
+
+	template <class T>
+	T random() { return T(std::uniform_real_distribution<float>(-1, 1)(rng)); }
+	template <class T>
+	uv::Vec3<T> random3() { return uv::vector(random<T>(), random<T>(), random<T>()); }
+	template <class T>
+	uv::Quat<T> random_rotation()
+	{
+		std::normal_distribution<T> normal;
+		const auto q = uv::quaternion(normal(rng), uv::vector(normal(rng), normal(rng), normal(rng)));
+		return q / length(q);
+	}
+	template <class T, size_t N>
+	uv::Mat<T, N, N> random_matrix()
+	{
+		uv::Mat<T, N, N> m;
+		for (size_t i = 0; i < N*N; ++i)
+			m.data()[i] = random<T>() / T(N);
+		for (size_t i = 0; i < N; ++i)
+			m.data()[i*N + i] += T(1);
+		return m;
+	}
+
+	template <class F>
+	auto batch(F f)
+	{
+		std::vector<decltype(f())> result;
+		result.reserve(batch_size);
+		while (result.size() < batch_size)
+			result.push_back(f());
+		return result;
+	}
+
+	template <class T>
+	void bench_vector(const char* scalar)
+	{
+		const auto b = random3<T>();
+		const float s = std::copysign(1.f, random<float>()); // unknown to the compiler, and keeps the chain from decaying
+		const auto in = batch(random3<T>);
+
+		latency(   "vector", "a+b", scalar, 3, random3<T>(), [&](const uv::Vec3<T>& a) { return a + b; });
+		throughput("vector", "a+b", scalar, 3, in, [&](const uv::Vec3<T>& a) { return a + b; });
+		latency(   "vector", "a*s", scalar, 3, random3<T>(), [&](const uv::Vec3<T>& a) { return a * s; });
+		throughput("vector", "a*s", scalar, 3, in, [&](const uv::Vec3<T>& a) { return a * s; });
+		throughput("vector", "dot", scalar, 5, in, [&](const uv::Vec3<T>& a) { return dot(a, b); });
+		throughput("vector", "cross", scalar, 9, in, [&](const uv::Vec3<T>& a) { return cross(a, b); });
+		throughput("vector", "length", scalar, 6, in, [&](const uv::Vec3<T>& a) { return length(a); });
+	}
+
+	template <class T>
+	void bench_matrix(const char* scalar)
+	{
+		using U = uv::type::identity<T>;
+		// rotation matrices keep the latency chains away from overflow and denormals
+		const auto m3 = matrix(random_rotation<U>());
+		const auto in = batch(random3<T>);
+
+		latency(   "matrix", "Mat33*Vec3", scalar, 15, random3<T>(), [&](const uv::Vec3<T>& v) { return m3 * v; });
+		throughput("matrix", "Mat33*Vec3", scalar, 15, in, [&](const uv::Vec3<T>& v) { return m3 * v; });
+
+		if constexpr (std::is_same_v<T, U>)
+		{
+			uv::Mat<T, 4, 4> m4;
+			for (size_t i = 0; i < 4; ++i)
+				for (size_t j = 0; j < 4; ++j)
+					m4.data()[4*i + j] = i < 3 && j < 3 ? m3.data()[3*i + j] : T(i == j);
+			const auto in4 = batch(random_matrix<T, 4>);
+			latency(   "matrix", "Mat44*Mat44", scalar, 112, m4, [&](const uv::Mat<T, 4, 4>& a) { return a * m4; });
+			throughput("matrix", "Mat44*Mat44", scalar, 112, in4, [&](const uv::Mat<T, 4, 4>& a) { return a * m4; });
+			throughput("matrix", "transpose(Mat44)", scalar, 0, in4, [&](const uv::Mat<T, 4, 4>& a) { return transpose(a); });
+			throughput("matrix", "det(Mat44)", scalar, 60, in4, [&](const uv::Mat<T, 4, 4>& a) { return det(a); });
+			throughput("matrix", "invert(Mat44)", scalar, 200, in4, [&](const uv::Mat<T, 4, 4>& a) { return invert(a); });
+			throughput("matrix", "invert(Mat33)", scalar, 50, batch(random_matrix<T, 3>), [&](const uv::Mat<T, 3, 3>& a) { return invert(a); });
+		}
+	}
+
+	template <class T>
+	void bench_rotation(const char* scalar)
+	{
+		using U = uv::type::identity<T>;
+		const auto q = random_rotation<U>();
+		const auto r = uv::rotation(q);
+
+		throughput("rotation", "Rot3*Vec3", scalar, 30, batch(random3<T>), [&](const uv::Vec3<T>& v) { return r * v; });
+
+		if constexpr (std::is_same_v<T, U>)
+		{
+			const auto qs = batch(random_rotation<T>);
+			const auto ms = batch([] { return matrix(random_rotation<T>()); });
+			const auto dirs = batch([] { return uv::direction(random3<T>()); });
+			const auto to = uv::direction(random3<T>());
+
+			latency(   "rotation", "Quat*Quat", scalar, 28, q, [&](const uv::Quat<T>& a) { return a * q; });
+			throughput("rotation", "Quat*Quat", scalar, 28, qs, [&](const uv::Quat<T>& a) { return a * q; });
+			throughput("rotation", "rotation(from,to)", scalar, 40, dirs, [&](const uv::Dir<T, 3>& from) { return quaternion(uv::rotation(from, to)); });
+			throughput("rotation", "matrix(Quat)", scalar, 30, qs, [&](const uv::Quat<T>& a) { return matrix(a); });
+			throughput("rotation", "quaternion(Mat33)", scalar, 25, ms, [&](const uv::Mat<T, 3, 3>& m) { return quaternion(m); });
+		}
+	}
+
+	void bench_angle()
+	{
+		const auto in = batch([] { return uv::degrees * (360 * random<double>()); });
+		latency(   "scalar", "Angle::sin", "Angle", 0, uv::degrees * 20, [](uv::Angle a) { return uv::degrees * (30 + 20 * double(a.sin())); });
+		throughput("scalar", "Angle::sin", "Angle", 0, in, [](uv::Angle a) { return double(a.sin()); });
+		throughput("scalar", "Angle::cos", "Angle", 0, in, [](uv::Angle a) { return double(a.cos()); });
+
+		const auto inf = batch([] { return uv::Anglef(uv::degrees * (360 * random<double>())); });
+		latency(   "scalar", "Anglef::sin", "Anglef", 0, uv::Anglef(uv::degrees * 20), [](uv::Anglef a) { return uv::Anglef(uv::degrees) * (30 + 20 * a.sin()); });
+		throughput("scalar", "Anglef::sin", "Anglef", 0, inf, [](uv::Anglef a) { return a.sin(); });
+		throughput("scalar", "rotation(Anglef)", "Anglef", 0, inf, [](uv::Anglef a) { return uv::rotation(a); });
+
+		std::vector<float> s(in.size()), c(in.size());
+		report("scalar", "sincos(span<Angle>)", "Angle", "throughput", time_per_op(in.size(), [&]
+		{
+			uv::sincos(gsl::span<const uv::Angle>(in.data(), in.size()), gsl::span<float>(s.data(), s.size()), gsl::span<float>(c.data(), c.size()));
+			keep(s[0]);
+		}), 0);
+		report("scalar", "sincos(span<Anglef>)", "Anglef", "throughput", time_per_op(inf.size(), [&]
+		{
+			uv::sincos(gsl::span<const uv::Anglef>(inf.data(), inf.size()), gsl::span<float>(s.data(), s.size()), gsl::span<float>(c.data(), c.size()));
+			keep(s[0]);
+		}), 0);
+		const auto radians = batch([] { return 7 * random<float>(); });
+		report("scalar", "sincos(span<float>)", "float", "throughput", time_per_op(radians.size(), [&]
+		{
+			uv::sincos(gsl::span<const float>(radians.data(), radians.size()), gsl::span<float>(s.data(), s.size()), gsl::span<float>(c.data(), c.size()));
+			keep(s[0]);
+		}), 0);
+	}
+
+	template <class T>
+	void bench_bounds(const char* scalar)
+	{
+		const auto p = random3<T>();
+		const auto c = bounds(random3<T>(), random3<T>());
+
+		latency(   "bounds", "bounds(B,p)", scalar, 6, c, [&](const uv::Bounds3<T>& a) { return bounds(a, p); });
+		throughput("bounds", "bounds(p,q)", scalar, 3, batch(random3<T>), [&](const uv::Vec3<T>& a) { return bounds(a, p); });
+		throughput("bounds", "intersect", scalar, 6, batch([] { return bounds(random3<T>(), random3<T>()); }), [&](const uv::Bounds3<T>& a)
+		{
+			uv::Bounds3<T> result;
+			for (size_t i = 0; i < 3; ++i)
+				result[i] = intersect(a[i], c[i]);
+			return result;
+		});
+	}
+
+	template <class T>
+	void bench_ray(const char* scalar)
+	{
+		const auto boxes = batch([] { const auto c = random3<T>() * 10; return bounds(c - T(1), c + T(1)); });
+		const uv::Bounds3SoA<T> soa(gsl::span<const uv::Bounds3<T>>(boxes.data(), boxes.size()));
+		const uv::Ray3<T> ray(random3<T>() * 20, random3<T>());
+		std::vector<T> entry(boxes.size());
+		std::unique_ptr<bool[]> hit(new bool[boxes.size()]);
+		// one box at a time from array-of-structures, against the whole batch from structure-of-arrays
+		report("ray", "intersect(Bounds3)", scalar, "throughput", time_per_op(boxes.size(), [&]
+		{
+			size_t hits = 0;
+			for (size_t i = 0; i < boxes.size(); ++i)
+			{
+				const auto range = intersect(ray, boxes[i]);
+				entry[i] = min(range);
+				hits += !(max(range) < min(range));
+			}
+			keep(hits);
+		}), 12);
+		report("ray", "intersect(Bounds3SoA)", scalar, "throughput", time_per_op(boxes.size(), [&]
+		{
+			keep(intersect(ray, soa, T(1000), gsl::span<T>(entry.data(), entry.size()), gsl::span<bool>(hit.get(), boxes.size())));
+		}), 12);
+	}
+
+	template <class T>
+	void bench_frustum(const char* scalar)
+	{
+		const T n = 1, f = 1000;
+		const uv::Frustum<T> frustum(uv::rows(
+			uv::vector<T>(1, 0, 0, 0),
+			uv::vector<T>(0, 1, 0, 0),
+			uv::vector<T>(0, 0, -(f + n)/(f - n), -2*f*n/(f - n)),
+			uv::vector<T>(0, 0, -1, 0)));
+		const auto boxes = batch([] { const auto c = random3<T>() * 100; return bounds(c - T(1), c + T(1)); });
+		const gsl::span<const uv::Bounds3<T>> all(boxes.data(), boxes.size());
+		std::vector<uint32_t> visible(boxes.size());
+		report("frustum", "culled(Bounds3)", scalar, "throughput", time_per_op(boxes.size(), [&]
+		{
+			size_t count = 0;
+			for (size_t i = 0; i < boxes.size(); ++i)
+				if (!culled(frustum, boxes[i]))
+					visible[count++] = uint32_t(i);
+			keep(count);
+		}), 0);
+		report("frustum", "cull(span<Bounds3>)", scalar, "throughput", time_per_op(boxes.size(), [&]
+		{
+			keep(cull(frustum, all, gsl::span<uint32_t>(visible.data(), visible.size())));
+		}), 0);
+	}
+
+	template <class T>
+	void bench_reduce(const char* scalar)
+	{
+		std::vector<uv::Point3<T>> cloud(1 << 22);
+		for (auto& p : cloud)
+			p = uv::Point3<T>(random3<T>());
+		const gsl::span<const uv::Point3<T>> points(cloud.data(), cloud.size());
+		// the hand-written loop on one core that the reductions replace
+		report("reduce", "loop sum", scalar, "throughput", time_per_op(cloud.size(), [&]
+		{
+			uv::Vec3<T> s(T(0));
+			for (const auto& p : cloud)
+				s = s + p.v;
+			keep(s);
+		}), 3);
+		report("reduce", "sum(span<Point3>)", scalar, "throughput", time_per_op(cloud.size(), [&] { keep(sum(points)); }), 3);
+		report("reduce", "bounds(span<Point3>)", scalar, "throughput", time_per_op(cloud.size(), [&] { keep(bounds(points)); }), 6);
+	}
+
+	template <class T>
+	void bench_stats(const char* scalar)
+	{
+		std::vector<uv::Point3<T>> cloud(16*batch_size);
+		for (auto& p : cloud)
+			p = uv::Point3<T>(random3<T>());
+		report("stats", "PointStats::add(Point3)", scalar, "throughput", time_per_op(cloud.size(), [&]
+		{
+			uv::PointStats3<T> s;
+			for (const auto& p : cloud)
+				s.add(p);
+			keep(s);
+		}), 0);
+		report("stats", "PointStats::add(span<Point3>)", scalar, "throughput", time_per_op(cloud.size(), [&]
+		{
+			uv::PointStats3<T> s;
+			s.add(gsl::span<const uv::Point3<T>>(cloud.data(), cloud.size()));
+			keep(s);
+		}), 0);
+	}
+
+	template <class T>
+	void bench_morton(const char* scalar)
+	{
+		const auto points = batch([] { return uv::Point3<T>(random3<T>()); });
+		const auto domain = bounds(gsl::span<const uv::Point3<T>>(points.data(), points.size()));
+		throughput("morton", "morton_code", scalar, 0, points, [&](const uv::Point3<T>& p) { return uv::morton_code(p, domain); });
+		throughput("morton", "morton_code<uint64_t>", scalar, 0, points, [&](const uv::Point3<T>& p) { return uv::morton_code<uint64_t>(p, domain); });
+		throughput("morton", "hilbert_code", scalar, 0, points, [&](const uv::Point3<T>& p) { return uv::hilbert_code(p, domain); });
+
+		std::vector<uv::Point3<T>> cloud(64*batch_size), work(cloud.size());
+		for (auto& p : cloud)
+			p = uv::Point3<T>(random3<T>());
+		report("morton", "morton_sort", scalar, "throughput", time_per_op(cloud.size(), [&]
+		{
+			work = cloud;
+			uv::morton_sort(gsl::span<uv::Point3<T>>(work.data(), work.size()));
+			keep(work[0]);
+		}), 0);
+		// for reference, the comparison sort it replaces
+		std::vector<uint32_t> codes(cloud.size());
+		report("morton", "std::sort by code", scalar, "throughput", time_per_op(cloud.size(), [&]
+		{
+			for (size_t i = 0; i < cloud.size(); ++i)
+				codes[i] = uv::morton_code(cloud[i], domain);
+			std::sort(codes.begin(), codes.end());
+			keep(codes[0]);
+		}), 0);
+	}
+
+	template <class T>
+	void bench_kdtree(const char* scalar)
+	{
+		using Tree = uv::KdTree3<T>;
+		std::vector<uv::Point3<T>> cloud(64*batch_size), work(cloud.size());
+		for (auto& p : cloud)
+			p = uv::Point3<T>(random3<T>() * 100);
+		Tree tree;
+		report("kdtree", "build", scalar, "throughput", time_per_op(cloud.size(), [&]
+		{
+			work = cloud;
+			tree.build(gsl::span<uv::Point3<T>>(work.data(), work.size()));
+			keep(tree);
+		}), 0);
+
+		const auto queries = batch([] { return uv::Point3<T>(random3<T>() * 100); });
+		const size_t k = 8;
+		std::vector<typename Tree::Neighbor> result(queries.size() * k);
+		throughput("kdtree", "nearest(k=8)", scalar, 0, queries, [&](const uv::Point3<T>& q)
+		{
+			return tree.nearest(q, gsl::span<typename Tree::Neighbor>(result.data(), k));
+		});
+		report("kdtree", "nearest(span, k=8)", scalar, "throughput", time_per_op(queries.size(), [&]
+		{
+			tree.nearest(gsl::span<const uv::Point3<T>>(queries.data(), queries.size()), k, gsl::span<typename Tree::Neighbor>(result.data(), result.size()));
+			keep(result[0]);
+		}), 0);
+		size_t found = 0;
+		throughput("kdtree", "radius(r=5)", scalar, 0, queries, [&](const uv::Point3<T>& q)
+		{
+			tree.radius(q, T(5), [&](size_t, uv::type::mul<T>) { ++found; });
+			return found;
+		});
+	}
+
+	template <class T>
+	void bench_hashgrid(const char* scalar)
+	{
+		using M = uv::type::mul<T>;
+		std::vector<uv::Point3<T>> cloud(64*batch_size);
+		for (auto& p : cloud)
+			p = uv::Point3<T>(random3<T>() * 100);
+		// sorted along the Morton curve, so that cells are numbered and stored roughly in space order
+		uv::morton_sort(gsl::span<uv::Point3<T>>(cloud.data(), cloud.size()));
+		uv::HashGrid3<T> grid(T(5));
+		report("hashgrid", "build(h=5)", scalar, "throughput", time_per_op(cloud.size(), [&]
+		{
+			grid.build(gsl::span<const uv::Point3<T>>(cloud.data(), cloud.size()));
+			keep(grid);
+		}), 0);
+
+		// scattered queries, and the particles themselves in cell order as a simulation step would visit them
+		const auto queries = batch([] { return uv::Point3<T>(random3<T>() * 100); });
+		std::vector<uv::Point3<T>> particles;
+		for (uint32_t c = 0; particles.size() < batch_size; ++c)
+			for (const auto& p : grid.points(c))
+				particles.push_back(p);
+		size_t found = 0;
+		const auto count = [&](size_t, M) { ++found; };
+		throughput("hashgrid", "neighbors(r=5)", scalar, 0, queries, [&](const uv::Point3<T>& q) { grid.neighbors(q, count); return found; });
+		throughput("hashgrid", "neighbors(r=5, particles)", scalar, 0, particles, [&](const uv::Point3<T>& q) { grid.neighbors(q, count); return found; });
+
+		std::vector<uv::Point3<T>> work = cloud;
+		const uv::KdTree3<T> tree(gsl::span<uv::Point3<T>>(work.data(), work.size()));
+		throughput("hashgrid", "kdtree radius(r=5, particles)", scalar, 0, particles, [&](const uv::Point3<T>& q) { tree.radius(q, T(5), count); return found; });
+	}
+
+	template <class T>
+	void bench_aabbtree(const char* scalar)
+	{
+		const auto random_box = []
+		{
+			const auto c = random3<T>() * 100;
+			const auto e = uv::vector(std::abs(random<T>()), std::abs(random<T>()), std::abs(random<T>()));
+			return bounds(c - e, c + e);
+		};
+		std::vector<uv::Bounds3<T>> boxes(16*batch_size);
+		for (auto& box : boxes)
+			box = random_box();
+		std::vector<uv::Vec3<T>> velocity(boxes.size());
+		for (auto& v : velocity)
+			v = random3<T>() * T(0.05);
+
+		uv::AabbTree<T> tree(T(0.25));
+		std::vector<uint32_t> proxies(boxes.size());
+		report("aabbtree", "insert", scalar, "throughput", time_per_op(boxes.size(), [&]
+		{
+			tree = uv::AabbTree<T>(T(0.25));
+			for (size_t i = 0; i < boxes.size(); ++i)
+				proxies[i] = tree.insert(boxes[i]);
+			keep(tree);
+		}), 0);
+		size_t pairs = 0;
+		tree.pairs([&](uint32_t, uint32_t) { ++pairs; });
+
+		// a simulation tick per body: every box moves a little, and the pairs of those that left their fat bounds are found
+		report("aabbtree", "tick(move, pairs)", scalar, "throughput", time_per_op(boxes.size(), [&]
+		{
+			for (size_t i = 0; i < boxes.size(); ++i)
+			{
+				boxes[i] = uv::bounds(min(boxes[i]) + velocity[i], max(boxes[i]) + velocity[i]);
+				tree.move(proxies[i], boxes[i], velocity[i]);
+			}
+			tree.pairs([&](uint32_t, uint32_t) { ++pairs; });
+			keep(pairs);
+		}), 0);
+		// the same tick with a bounding volume hierarchy rebuilt from scratch and queried with every box
+		const gsl::span<const uv::Bounds3<T>> all(boxes.data(), boxes.size());
+		uv::Bvh<T> bvh;
+		report("aabbtree", "tick(bvh build, overlap)", scalar, "throughput", time_per_op(boxes.size(), [&]
+		{
+			bvh.build(all);
+			for (const auto& box : boxes)
+				bvh.overlap(box, [&](size_t) { ++pairs; });
+			keep(pairs);
+		}), 0);
+	}
+
+	template <class T>
+	void bench_octree(const char* scalar)
+	{
+		using Tree = uv::Octree<T>;
+		using Field = typename Tree::Field;
+		std::vector<uv::Point3<T>> bodies(4*batch_size);
+		std::vector<float> masses(bodies.size());
+		for (size_t i = 0; i < bodies.size(); ++i)
+		{
+			bodies[i] = uv::Point3<T>(random3<T>() * 100);
+			masses[i] = 1 + std::abs(random<float>());
+		}
+		const gsl::span<const uv::Point3<T>> points(bodies.data(), bodies.size());
+		const gsl::span<const float> charges(masses.data(), masses.size());
+		Tree tree;
+		report("octree", "build", scalar, "throughput", time_per_op(bodies.size(), [&] { tree.build(points, charges); keep(tree); }), 0);
+
+		std::vector<uv::Vec3<Field>> field(bodies.size());
+		for (const float theta : { 0.3f, 0.7f })
+		{
+			char op[32];
+			std::snprintf(op, sizeof(op), "field(theta=%.1f)", theta);
+			report("octree", op, scalar, "throughput", time_per_op(bodies.size(), [&]
+			{
+				tree.field(gsl::span<uv::Vec3<Field>>(field.data(), field.size()), theta);
+				keep(field[0]);
+			}), 0);
+		}
+		// the exact sum over all bodies, for a few of them
+		const size_t sample = 256;
+		report("octree", "field(direct)", scalar, "throughput", time_per_op(sample, [&]
+		{
+			for (size_t i = 0; i < sample; ++i)
+			{
+				uv::Vec3<Field> acc(Field(0));
+				for (size_t j = 0; j < bodies.size(); ++j)
+				{
+					const auto d = bodies[j] - bodies[i];
+					const auto r2 = square(d);
+					acc = acc + d * (r2 > decltype(r2)(0) ? masses[j] / (r2 * T(sqrt(r2))) : Field(0));
+				}
+				field[i] = acc;
+			}
+			keep(field[0]);
+		}), 0);
+	}
+
+	template <class T>
+	void bench_slerp(const char* scalar)
+	{
+		const auto random_rot3 = [] { return uv::rotation(random_rotation<T>()); };
+		const auto pairs = batch([&] { return std::make_pair(random_rot3(), random_rot3()); });
+		using Pair = std::pair<uv::Rot3<T>, uv::Rot3<T>>;
+		throughput("slerp", "nlerp", scalar, 0, pairs, [](const Pair& p) { return nlerp(p.first, p.second, T(0.3)); });
+		throughput("slerp", "slerp", scalar, 0, pairs, [](const Pair& p) { return slerp(p.first, p.second, T(0.3)); });
+		throughput("slerp", "fast_slerp", scalar, 0, pairs, [](const Pair& p) { return fast_slerp(p.first, p.second, T(0.3)); });
+
+		// frames of a crowd of 64 skeletons of 64 bones, each track with 30 keys, sampled with time moving forward
+		uv::RotationTracks<T> tracks;
+		std::vector<T> times(30);
+		std::vector<uv::Rot3<T>> keys(times.size(), uv::Rot3<T>(uv::identity));
+		for (size_t i = 0; i < batch_size; ++i)
+		{
+			for (size_t k = 0; k < times.size(); ++k)
+			{
+				times[k] = T(k) + T(0.5)*std::abs(random<T>());
+				keys[k] = random_rot3();
+			}
+			tracks.add(gsl::span<const T>(times.data(), times.size()), gsl::span<const uv::Rot3<T>>(keys.data(), keys.size()));
+		}
+		std::vector<uv::Rot3<T>> pose(tracks.size(), uv::Rot3<T>(uv::identity));
+		T time = 0;
+		report("slerp", "tracks.sample(track, time)", scalar, "throughput", time_per_op(tracks.size(), [&]
+		{
+			time = time + T(0.01);
+			for (size_t i = 0; i < tracks.size(); ++i)
+				pose[i] = tracks.sample(i, time);
+			keep(pose[0]);
+		}), 0);
+		report("slerp", "tracks.sample(time, span)", scalar, "throughput", time_per_op(tracks.size(), [&]
+		{
+			time = time + T(0.01);
+			tracks.sample(time, gsl::span<uv::Rot3<T>>(pose.data(), pose.size()));
+			keep(pose[0]);
+		}), 0);
+	}
+
+	template <class T>
+	void bench_skin(const char* scalar)
+	{
+		// a mesh of 16k vertices on 64 joints, each vertex with four influences
+		const size_t joints = 64, vertices = 4*batch_size;
+		std::vector<uv::Trans3<T>> pose;
+		std::vector<uv::DualQuat<T>> dqs;
+		std::vector<uv::Mat<T, 4, 4>> matrices;
+		for (size_t j = 0; j < joints; ++j)
+		{
+			pose.emplace_back(uv::rotation(random_rotation<T>()), random3<T>());
+			dqs.emplace_back(pose.back());
+			matrices.push_back(homogeneous(pose.back()));
+		}
+		uv::SkinWeights<T> weights;
+		uv::VecArray<T, 3> positions, out;
+		for (size_t i = 0; i < vertices; ++i)
+		{
+			const auto j = [] { return uint32_t(rng() % joints); };
+			weights.joints.push_back(uv::Vec<uint32_t, 4>(j(), j(), j(), j()));
+			weights.weights.push_back(uv::vector(T(0.4), T(0.3), T(0.2), T(0.1)));
+			positions.push_back(random3<T>());
+		}
+		const gsl::span<const uv::DualQuat<T>> joint_span(dqs.data(), dqs.size());
+		report("skin", "skin(DualQuat)", scalar, "throughput", time_per_op(vertices, [&]
+		{
+			skin(joint_span, weights, positions, out);
+			keep(out.lane(0)[0]);
+		}), 0);
+		// linear blend skinning: the weighted sum of the matrices of the influences, applied to each vertex
+		report("skin", "blend homogeneous(Trans3)", scalar, "throughput", time_per_op(vertices, [&]
+		{
+			for (size_t i = 0; i < vertices; ++i)
+			{
+				uv::Mat<T, 4, 4> m = matrices[weights.joints.lane(0)[i]] * weights.weights.lane(0)[i];
+				for (size_t k = 1; k < 4; ++k)
+					m = m + matrices[weights.joints.lane(k)[i]] * weights.weights.lane(k)[i];
+				const auto v = m * uv::vector(positions.lane(0)[i], positions.lane(1)[i], positions.lane(2)[i], T(1));
+				out.set(i, uv::vector(v[0], v[1], v[2]));
+			}
+			keep(out.lane(0)[0]);
+		}), 0);
+	}
+
+	template <class T>
+	void bench_lie(const char* scalar)
+	{
+		const auto phis = batch([] { return random3<T>(); });
+		const auto small = batch([] { return random3<T>() * T(1e-3); });
+		const auto rs = batch([] { return uv::rotation(random_rotation<T>()); });
+		const auto xis = batch([] { return uv::Twist<T>{ random3<T>(), random3<T>() }; });
+		const auto tfs = batch([] { return uv::Trans3<T>(uv::rotation(random_rotation<T>()), random3<T>()); });
+		throughput("lie", "rotation(Vec3)", scalar, 0, phis, [](const uv::Vec3<T>& v) { return uv::rotation(v); });
+		throughput("lie", "exp(Vec3)", scalar, 0, phis, [](const uv::Vec3<T>& v) { return exp(v); });
+		throughput("lie", "exp(small Vec3)", scalar, 0, small, [](const uv::Vec3<T>& v) { return exp(v); });
+		throughput("lie", "vector(Rot3)", scalar, 0, rs, [](const uv::Rot3<T>& r) { return vector(r); });
+		throughput("lie", "log(Rot3)", scalar, 0, rs, [](const uv::Rot3<T>& r) { return log(r); });
+		throughput("lie", "exp(Twist)", scalar, 0, xis, [](const uv::Twist<T>& xi) { return exp(xi); });
+		throughput("lie", "log(Trans3)", scalar, 0, tfs, [](const uv::Trans3<T>& tf) { return log(tf); });
+		throughput("lie", "left_jacobian(Vec3)", scalar, 0, phis, [](const uv::Vec3<T>& v) { return left_jacobian(v); });
+		throughput("lie", "right_jacobian_inverse(Vec3)", scalar, 0, phis, [](const uv::Vec3<T>& v) { return right_jacobian_inverse(v); });
+	}
+
+	template <class T>
+	void bench_hierarchy(const char* scalar)
+	{
+		// 64 characters of 256 bones, each bone below one of the 8 before it
+		const size_t characters = 64, bones = 256, nodes = characters*bones;
+		uv::TransformHierarchy<T> hierarchy(true);
+		for (size_t c = 0; c < characters; ++c)
+		{
+			const uint32_t root = hierarchy.add(uv::Trans3<T>(uv::rotation(random_rotation<T>()), random3<T>()));
+			for (size_t b = 1; b < bones; ++b)
+				hierarchy.add(uv::Trans3<T>(uv::rotation(random_rotation<T>()), random3<T>()), uint32_t(root + b - 1 - rng() % std::min<size_t>(b, 8)));
+		}
+		// recomputing every node in order, as without the hierarchy
+		std::vector<uv::Trans3<T>> world(hierarchy.world());
+		std::vector<uv::Mat<T, 4, 4>> matrices(hierarchy.matrices());
+		report("hierarchy", "recompute all", scalar, "throughput", time_per_op(nodes, [&]
+		{
+			for (uint32_t i = 0; i < nodes; ++i)
+			{
+				const uint32_t p = hierarchy.parent(i);
+				world[i] = p == hierarchy.none ? hierarchy.local(i) : world[p] * hierarchy.local(i);
+				matrices[i] = homogeneous(world[i]);
+			}
+			keep(matrices[nodes - 1]);
+		}), 0);
+		report("hierarchy", "update() all dirty", scalar, "throughput", time_per_op(nodes, [&]
+		{
+			for (uint32_t c = 0; c < characters; ++c)
+				hierarchy.set_local(c*bones, hierarchy.local(c*bones));
+			keep(hierarchy.update(1));
+		}), 0);
+		// a few animated bones per frame, timed per node of the hierarchy
+		const std::vector<uint32_t> animated = [&]
+		{
+			std::vector<uint32_t> a;
+			for (size_t i = 0; i < nodes / 256; ++i)
+				a.push_back(uint32_t(rng() % nodes));
+			return a;
+		}();
+		report("hierarchy", "update() 1/256 set", scalar, "throughput", time_per_op(nodes, [&]
+		{
+			for (const uint32_t i : animated)
+				hierarchy.set_local(i, hierarchy.local(i));
+			keep(hierarchy.update(1));
+		}), 0);
+	}
+
+	template <class T>
+	void bench_bvh(const char* scalar)
+	{
+		const auto random_box = []
+		{
+			const auto c = random3<T>() * 100;
+			const auto e = uv::vector(std::abs(random<T>()), std::abs(random<T>()), std::abs(random<T>()));
+			return bounds(c - e, c + e);
+		};
+		std::vector<uv::Bounds3<T>> boxes(16*batch_size);
+		for (auto& box : boxes)
+			box = random_box();
+		const gsl::span<const uv::Bounds3<T>> all(boxes.data(), boxes.size());
+
+		uv::Bvh<T> bvh;
+		report("bvh", "build", scalar, "throughput", time_per_op(boxes.size(), [&] { bvh.build(all); keep(bvh); }), 0);
+		report("bvh", "refit", scalar, "throughput", time_per_op(boxes.size(), [&] { bvh.refit(all); keep(bvh); }), 0);
+
+		size_t hits = 0;
+		throughput("bvh", "overlap", scalar, 0, batch(random_box), [&](const uv::Bounds3<T>& box) { bvh.overlap(box, [&](size_t) { ++hits; }); return hits; });
+		// rays from outside the cloud, stopping at the first box
+		const auto dirs = batch([] { return uv::direction(random3<T>()); });
+		throughput("bvh", "raycast", scalar, 0, dirs, [&](const uv::Dir<T, 3>& d)
+		{
+			T nearest = T(1000);
+			bvh.raycast(uv::Ray3<T>(d * T(-200), d), nearest, [&](size_t, T& tmax) { nearest = tmax = T(0); });
+			return nearest;
+		});
+	}
+
+	template <class T>
+	void bench_complex(const char* scalar)
+	{
+		const auto random_complex = [] { return uv::Complex<T>(random<T>() + uv::imaginary * random<T>()); };
+		const auto c = random_complex();
+		const auto unit = c / std::sqrt(square(c));
+		const auto in = batch(random_complex);
+
+		latency(   "complex", "c*c", scalar, 6, random_complex(), [&](const uv::Complex<T>& a) { return a * unit; });
+		throughput("complex", "c*c", scalar, 6, in, [&](const uv::Complex<T>& a) { return a * c; });
+		throughput("complex", "c/c", scalar, 11, in, [&](const uv::Complex<T>& a) { return a / c; });
+	}
+
+	template <class T>
+	void bench_transform(const char* scalar)
+	{
+		using U = uv::type::identity<T>;
+		const auto random_transform = [] { return uv::Trans3<T>(uv::rotation(random_rotation<U>()), random3<T>()); };
+		const auto tf = random_transform();
+		const auto tfs = batch(random_transform);
+
+		latency(   "transform", "Trans3*Point3", scalar, 33, uv::point(random3<T>()), [&](const uv::Point3<T>& p) { return tf * p; });
+		throughput("transform", "Trans3*Point3", scalar, 33, batch([] { return uv::point(random3<T>()); }), [&](const uv::Point3<T>& p) { return tf * p; });
+		throughput("transform", "Trans3*Trans3", scalar, 61, tfs, [&](const uv::Trans3<T>& a) { return tf * a; });
+		throughput("transform", "invert(Trans3)", scalar, 31, tfs, [&](const uv::Trans3<T>& a) { return invert(a); });
+
+		// scaled transforms, against the 4x4 matrices they would otherwise be
+		const auto random_sim = [] { return uv::Sim3<T>(uv::rotation(random_rotation<U>()), U(1) + std::abs(random<U>()), random3<T>()); };
+		const auto sim = random_sim();
+		const auto sims = batch(random_sim);
+		const auto m = homogeneous(sim);
+		const auto ms = batch([&] { return homogeneous(random_sim()); });
+		throughput("transform", "Sim3*Point3", scalar, 36, batch([] { return uv::point(random3<T>()); }), [&](const uv::Point3<T>& p) { return sim * p; });
+		throughput("transform", "Mat44*Vec4", scalar, 28, batch([] { const auto v = random3<T>(); return uv::vector(v[0] / T(1), v[1] / T(1), v[2] / T(1), U(1)); }), [&](const uv::Vec<U, 4>& v) { return m * v; });
+		throughput("transform", "Sim3*Sim3", scalar, 65, sims, [&](const uv::Sim3<T>& a) { return sim * a; });
+		throughput("transform", "Mat44*Mat44", scalar, 112, ms, [&](const uv::Mat<U, 4, 4>& a) { return m * a; });
+		throughput("transform", "invert(Sim3)", scalar, 35, sims, [&](const uv::Sim3<T>& a) { return invert(a); });
+		throughput("transform", "invert(Mat44)", scalar, 0, ms, [&](const uv::Mat<U, 4, 4>& a) { return invert(a); });
+		throughput("transform", "invert_affine(Mat44)", scalar, 0, ms, [&](const uv::Mat<U, 4, 4>& a) { return invert_affine(a); });
+	}
+
+	// quaternion(const Mat&) as it was before Shepperd's method, kept for comparison
+	template <class T>
+	uv::Quat<T> quaternion_cbrt(const uv::Mat<T, 3, 3>& m)
+	{
+		const T scale = std::cbrt(det(m));
+		auto& mr = rows(m);
+		return uv::quaternion(sqrt(std::max(T(0), scale + mr[0][0] + mr[1][1] + mr[2][2])) / 2,
+			uv::vector(
+			copysign(sqrt(std::max(T(0), scale + mr[0][0] - mr[1][1] - mr[2][2])) / 2, mr[2][1] - mr[1][2]),
+			copysign(sqrt(std::max(T(0), scale - mr[0][0] + mr[1][1] - mr[2][2])) / 2, mr[0][2] - mr[2][0]),
+			copysign(sqrt(std::max(T(0), scale - mr[0][0] - mr[1][1] + mr[2][2])) / 2, mr[1][0] - mr[0][1])));
+	}
+
+	// Largest angle between the original and the round-tripped rotation, in radians
+	template <class T>
+	double max_error(const std::vector<uv::Quat<T>>& expected, const std::vector<uv::Quat<T>>& actual)
+	{
+		double worst = 0;
+		for (size_t i = 0; i < expected.size(); ++i)
+		{
+			const uv::Quat<double> e = expected[i], a = actual[i];
+			const auto r = conjugate(e) * a;
+			worst = std::max(worst, 2 * std::atan2(length(r.im), std::abs(r.re)));
+		}
+		return worst;
+	}
+
+	// Timings go with the other results, the round-trip errors to stderr
+	template <class T>
+	void bench_quaternion_from_matrix(const char* scalar)
+	{
+		const auto expected = batch(random_rotation<T>);
+		std::vector<uv::Mat<T, 3, 3>> matrices;
+		for (auto& q : expected)
+			matrices.push_back(matrix(q));
+		const size_t n = matrices.size();
+		std::vector<uv::Quat<T>> result(n);
+
+		const double legacy = time_per_op(n, [&] { for (size_t i = 0; i < n; ++i) result[i] = quaternion_cbrt(matrices[i]); keep(result[0]); });
+		const double legacy_error = max_error(expected, result);
+		for (size_t i = 0; i < n; ++i)
+			result[i] = quaternion(matrices[i]);
+		const double scalar_error = max_error(expected, result);
+		const double packed = time_per_op(n, [&] { quaternion(gsl::span<const uv::Mat<T, 3, 3>>(matrices.data(), n), gsl::span<uv::Quat<T>>(result.data(), n)); keep(result[0]); });
+		const double packed_error = max_error(expected, result);
+
+		report("rotation", "quaternion(Mat33) cbrt", scalar, "throughput", legacy, 30);
+		report("rotation", "quaternion(span<Mat33>)", scalar, "throughput", packed, 25);
+		std::fprintf(stderr, "quaternion(Mat33) %s max round-trip error: cbrt %.3g rad, Shepperd %.3g rad, batch %.3g rad\n",
+			scalar, legacy_error, scalar_error, packed_error);
+	}
+}
+
+int main()
+{
+	using units::Distance;
+	std::printf("header\toperation\tscalar\tmode\tns_per_op\tgflops\n");
+
+	bench_vector<float>("float");
+	bench_vector<double>("double");
+	bench_vector<Distance<float>>("Distance");
+
+	bench_matrix<float>("float");
+	bench_matrix<double>("double");
+	bench_matrix<Distance<float>>("Distance");
+
+	bench_rotation<float>("float");
+	bench_rotation<double>("double");
+	bench_rotation<Distance<float>>("Distance");
+	bench_quaternion_from_matrix<float>("float");
+	bench_quaternion_from_matrix<double>("double");
+	bench_angle();
+
+	bench_bounds<float>("float");
+	bench_bounds<double>("double");
+	bench_bounds<Distance<float>>("Distance");
+
+	bench_ray<float>("float");
+	bench_ray<double>("double");
+	bench_frustum<float>("float");
+	bench_frustum<double>("double");
+	bench_reduce<float>("float");
+	bench_reduce<double>("double");
+	bench_stats<float>("float");
+	bench_stats<double>("double");
+	bench_morton<float>("float");
+	bench_kdtree<float>("float");
+	bench_hashgrid<float>("float");
+	bench_aabbtree<float>("float");
+	bench_octree<float>("float");
+	bench_slerp<float>("float");
+	bench_skin<float>("float");
+	bench_lie<float>("float");
+	bench_lie<double>("double");
+	bench_hierarchy<float>("float");
+	bench_bvh<float>("float");
+	bench_bvh<double>("double");
+
+	bench_complex<float>("float");
+	bench_complex<double>("double");
+
+	bench_transform<float>("float");
+	bench_transform<double>("double");
+	bench_transform<Distance<float>>("Distance");
+}
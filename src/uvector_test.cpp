@@ -3,10 +3,29 @@
 #include <uvector/transform.h>
 #include <uvector/bounds.h>
 #include <uvector/complex.h>
+#include <uvector/array.h>
+#include <uvector/simd.h>
+#include <uvector/eigen.h>
+#include <uvector/ray.h>
+#include <uvector/frustum.h>
+#include <uvector/reduce.h>
+#include <uvector/stats.h>
+#include <uvector/morton.h>
+#include <uvector/kdtree.h>
+#include <uvector/hashgrid.h>
+#include <uvector/aabbtree.h>
+#include <uvector/octree.h>
+#include <uvector/track.h>
+#include <uvector/dualquat.h>
+#include <uvector/lie.h>
+#include <uvector/hierarchy.h>
+#include <uvector/bvh.h>
 #include <units.h>
 
 #include <tester_with_macros.h>
 #include <random>
+#include <set>
+#include <unordered_map>
 
 using namespace uv::axes;
 
@@ -101,6 +120,40 @@ void test_arithmetics(const T& a, const T& b, const typename T::value_type c)
 	CHECK_APPROX(a / c == uv::vector(a[0] / c, a[1] / c, a[2] / c, a[3] / c));
 }
 template <class T>
+void test_lazy(const T& a, const T& b, const typename T::value_type c)
+{
+	using uv::lazy;
+	const T r = lazy(a)*2 + lazy(b)/c*c - a;
+	CHECK_APPROX(r == a*2 + b/c*c - a);
+	CHECK_APPROX(dot(lazy(a) - b, a) == dot(a - b, a));
+	CHECK_APPROX(square(lazy(a) + b) == square(a + b));
+
+	T s = a;
+	s[XY] += lazy(b[XY]);
+	s[ZW] *= 2;
+	CHECK(s == uv::vector(a[0] + b[0], a[1] + b[1], a[2] * 2, a[3] * 2));
+
+	// operands reading the target are evaluated before it is written
+	T w = a;
+	w[XY] += lazy(w[YZ]);
+	CHECK(w == uv::vector(a[0] + a[1], a[1] + a[2], a[2], a[3]));
+	w = a;
+	w[YZ] += lazy(w[XY]);
+	CHECK(w == uv::vector(a[0], a[1] + a[0], a[2] + a[1], a[3]));
+	w = a;
+	w[XYZ] -= lazy(b[XYZ]) * 2 + w[Z|X|Y];
+	CHECK(w == uv::vector(a[0] - (b[0] * 2 + a[2]), a[1] - (b[1] * 2 + a[0]), a[2] - (b[2] * 2 + a[1]), a[3]));
+	w = a;
+	w += lazy(w);
+	CHECK(w == a + a);
+	w = a;
+	w[YW] = lazy(w[XY]);
+	CHECK(w == uv::vector(a[0], a[0], a[2], a[1]));
+	w = a;
+	w[ZW] = lazy(w[YZ]) + b[XY];
+	CHECK(w == uv::vector(a[0], a[1], a[1] + b[0], a[2] + b[1]));
+}
+template <class T>
 void test_dot_product(const T& a, const T& b)
 {
 	CHECK_APPROX(dot(a, b) == (a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3]));
@@ -169,6 +222,28 @@ void test_bounds(const uv::Vec<T, N>& a, const uv::Vec<T, N>& b, const T c)
 	CHECK(min(ab[0]) >= min(abc[0]));
 }
 
+template <class T, size_t N>
+void test_vec_array(const uv::Vec<T, N>& a, const uv::Vec<T, N>& b, const T c)
+{
+	uv::VecArray<T, 3> va(2), vb(2);
+	va.set(0, a[XYZ]); va.set(1, b[XYZ]);
+	vb.set(0, b[XYZ]); vb.set(1, a[XYZ]);
+
+	const auto vs = (va + vb)*c;
+	const auto vd = dot(va, vb);
+	const auto vx = cross(va, vb);
+	const auto vm = ifelse(va < vb, va, vb);
+	const uv::ScalarArray<T> vl = sqrt(square(va));
+	for (size_t i = 0; i < 2; ++i)
+	{
+		CHECK_APPROX(vs[i] == (va[i] + vb[i])*c);
+		CHECK_APPROX(vd[i] == dot(va[i], vb[i]));
+		CHECK_APPROX(vx[i] == cross(va[i], vb[i]));
+		CHECK(vm[i] == min(va[i], vb[i]));
+		CHECK_APPROX(vl[i] == length(va[i]));
+	}
+}
+
 template <class T, size_t N>
 void test_matrix(const uv::Vec<T, N>& a)
 {
@@ -201,6 +276,69 @@ void test_matrix(const uv::Vec<T, N>& a)
 	CHECK_EACH(rows(B) == cols(B));
 	
 	CHECK_EACH(rows(A*B) == rows(rows(d[0] * rows(B)[0], d[1] * rows(B)[1], d[2] * rows(B)[2], d[3] * rows(B)[3])));
+
+	tester::presicion = 1e-5f;
+	uv::Mat<float, N, N> M;
+	uv::Mat<float, 3, N> M3;
+	for (size_t i = 0; i < N; ++i)
+		for (size_t j = 0; j < N; ++j)
+			rows(M)[i][j] = rows(M3)[j % 3][i] = signed_unit_float();
+
+	const auto Ma = M*a;
+	const auto aM = a*M;
+	const auto M3a = M3*a;
+	const auto MB = M*B;
+	const auto Mt = transpose(M);
+	// products are compared relative to the largest their terms can sum to, as fuzzed inputs can cancel to near zero
+	const auto scale = [&](const uv::Vec<float, N>& m) { return length(m)*length(a); };
+	for (size_t i = 0; i < N; ++i)
+	{
+		CHECK_APPROX(Ma[i]/scale(rows(M)[i]) == dot(rows(M)[i], a)/scale(rows(M)[i]));
+		CHECK_APPROX(aM[i]/scale(cols(M)[i]) == dot(a, cols(M)[i])/scale(cols(M)[i]));
+		CHECK(rows(Mt)[i] == cols(M)[i]);
+		for (size_t j = 0; j < N; ++j)
+			CHECK_APPROX(rows(MB)[i][j] == dot(rows(M)[i], cols(B)[j]));
+	}
+	for (size_t i = 0; i < 3; ++i)
+		CHECK_APPROX(M3a[i]/scale(rows(M3)[i]) == dot(rows(M3)[i], a)/scale(rows(M3)[i]));
+
+	const uv::Mat<float, N, N> Md = M + uv::Mat<float, N, N>(4.0f);
+	const auto I = Md*invert(Md);
+	uv::Mat<float, N, N> Af = Md;
+	rows(Af)[3] = uv::vector(0.f, 0.f, 0.f, 1.f);
+	const auto Afi = invert(Af);
+	const auto Afa = invert_affine(Af);
+	const uv::Mat<float, 2, 2> M2 = rows(rows(Md)[0][XY], rows(Md)[1][XY]);
+	const auto I2 = invert(M2)*M2;
+	CHECK_APPROX(det(Md)*det(invert(Md)) == 1);
+	for (size_t i = 0; i < N; ++i)
+		for (size_t j = 0; j < N; ++j)
+		{
+			CHECK_APPROX(rows(I)[i][j] == (i == j ? 1.f : 0.f));
+			CHECK_APPROX(rows(Afa)[i][j] == rows(Afi)[i][j]);
+			CHECK_APPROX(rows(I2)[i % 2][j % 2] == (i % 2 == j % 2 ? 1.f : 0.f));
+		}
+
+	// sizes without a packed inverse go through the LU decomposition, here with the largest element of every column
+	// off the diagonal, so that rows are swapped
+	uv::Mat<double, N, N> Pd;
+	uv::Mat<float, 5, 5> P5;
+	for (size_t i = 0; i < 5; ++i)
+		for (size_t j = 0; j < 5; ++j)
+		{
+			rows(P5)[i][j] = signed_unit_float() + (j == (i + 1) % 5 ? 4.f : 0.f);
+			if (i < N && j < N)
+				rows(Pd)[i][j] = rows(M)[i][j] + (j == (i + 1) % N ? 4. : 0.);
+		}
+	const auto Id = Pd*invert(Pd);
+	const auto I5 = invert(P5)*P5;
+	for (size_t i = 0; i < 5; ++i)
+		for (size_t j = 0; j < 5; ++j)
+		{
+			if (i < N && j < N)
+				CHECK_APPROX(rows(Id)[i][j] == (i == j ? 1. : 0.));
+			CHECK_APPROX(rows(I5)[i][j] == (i == j ? 1.f : 0.f));
+		}
 }
 
 void test_pi()
@@ -233,6 +371,48 @@ void test_pi()
 	}
 }
 
+void test_anglef()
+{
+	tester::section = "Anglef";
+	tester::presicion = 2e-7f;
+
+	constexpr uv::Anglef degrees = uv::degrees;
+	for (int i = -24; i <= 24; ++i)
+	{
+		CHECK(sin(i*30*degrees) == float(sin(i*30*uv::degrees)));
+		CHECK(cos(i*30*degrees) == float(cos(i*30*uv::degrees)));
+		CHECK(sin(i*45*degrees) == float(sin(i*45*uv::degrees)));
+		CHECK(cos(i*45*degrees) == float(cos(i*45*uv::degrees)));
+	}
+	CHECK(sin(45*degrees) == cos(45*degrees));
+
+	const auto r2 = rotation(90*degrees);
+	CHECK(r2*X == uv::vector<float>(0, +1));
+	CHECK(r2*Y == uv::vector<float>(-1, 0));
+
+	std::vector<float> values;
+	std::vector<uv::Anglef> angles;
+	std::vector<float> radians;
+	for (int i = -3600; i <= 3600; i += 7)
+	{
+		values.push_back(i*0.1f);
+		angles.push_back(values.back()*degrees);
+		radians.push_back(angles.back());
+	}
+	std::vector<float> s(angles.size()), c(angles.size()), rs(angles.size()), rc(angles.size());
+	uv::sincos(gsl::span<const uv::Anglef>(angles.data(), angles.size()), gsl::span<float>(s.data(), s.size()), gsl::span<float>(c.data(), c.size()));
+	uv::sincos(gsl::span<const float>(radians.data(), radians.size()), gsl::span<float>(rs.data(), rs.size()), gsl::span<float>(rc.data(), rc.size()));
+	for (size_t i = 0; i < angles.size(); ++i)
+	{
+		const double exact = values[i]*3.14159265358979323846/180;
+		CHECK_APPROX(s[i] == float(std::sin(exact)));
+		CHECK_APPROX(c[i] == float(std::cos(exact)));
+		CHECK_APPROX(rs[i] == float(std::sin(double(radians[i]))));
+		CHECK_APPROX(rc[i] == float(std::cos(double(radians[i]))));
+		CHECK(s[i] == angles[i].sin());
+	}
+}
+
 void test_quaternion(const uv::Vec<float, 4>& v)
 {
 	tester::presicion = 5e-5f;
@@ -255,6 +435,14 @@ void test_quaternion(const uv::Vec<float, 4>& v)
 	CHECK_APPROX(r * Z == rm * Z);
 	auto rmr = rotation(rm);
 	CHECK_APPROX(uv::vector(quaternion(r).re, quaternion(r).im) == uv::vector(quaternion(rmr).re, quaternion(rmr).im));
+
+	tester::presicion = 1e-6f;
+	std::vector<uv::float33> ms(9, rm);
+	ms[3] = matrix(R);
+	std::vector<uv::floatq> qs(ms.size());
+	quaternion(gsl::span<const uv::float33>(ms.data(), ms.size()), gsl::make_span(qs));
+	CHECK_APPROX(uv::vector(qs[8].re, qs[8].im) == uv::vector(quaternion(rm).re, quaternion(rm).im));
+	CHECK_APPROX(uv::vector(qs[3].re, qs[3].im) == uv::vector(quaternion(R).re, quaternion(R).im));
 }
 void test_quaternion(const uv::Vec<units::Distance<float>, 4>&)
 { 
@@ -297,6 +485,1247 @@ void test_rotate(const uv::Vec<units::Distance<float>, 4>&)
 
 }
 
+template <class T>
+void test_batch_transform(const uv::Vec<T, 4>& a, const uv::Vec<T, 4>& b)
+{
+	tester::presicion = 2e-4f;
+	const auto r = rotation(uv::quaternion(abs(signed_unit_float()), uv::vector(signed_unit_float(), signed_unit_float(), signed_unit_float())));
+	const uv::Trans3<T> tf(r, b[XYZ]);
+
+	std::vector<uv::Point3<T>> points = { uv::point(a[XYZ]), uv::point(b[Y|Z|X]), uv::point(a[Z|X|Y] - b[XYZ]) };
+	std::vector<uv::Point3<T>> moved(points.size());
+	transform(tf, gsl::span<const uv::Point3<T>>(points.data(), points.size()), gsl::span<uv::Point3<T>>(moved.data(), moved.size()));
+
+	std::vector<uv::Vec3<T>> vectors(points.size());
+	for (size_t i = 0; i < points.size(); ++i)
+		vectors[i] = points[i].v;
+	const uv::VecArray<T, 3> soa(gsl::span<const uv::Vec3<T>>(vectors.data(), vectors.size()));
+	uv::VecArray<T, 3> soa_moved;
+	transform(tf, soa, soa_moved);
+	transform(r, gsl::span<const uv::Vec3<T>>(vectors.data(), vectors.size()), gsl::span<uv::Vec3<T>>(vectors.data(), vectors.size()));
+
+	for (size_t i = 0; i < points.size(); ++i)
+	{
+		CHECK_APPROX(moved[i].v == (tf*points[i]).v);
+		CHECK_APPROX(soa_moved[i] == (tf*points[i]).v);
+		CHECK_APPROX(vectors[i] == r*points[i].v);
+	}
+}
+
+void test_eigen(const uv::Vec<float, 4>&, const uv::Vec<float, 4>&)
+{
+	tester::presicion = 1e-4f;
+	uv::float33 m;
+	for (size_t i = 0; i < 3; ++i)
+		cols(m)[i] = uv::vector(signed_unit_float(), signed_unit_float(), signed_unit_float());
+	const uv::float33 s = m*transpose(m) + uv::float33(signed_unit_float());
+
+	const auto e = eigen(s);
+	const auto R = matrix(e.vectors);
+	CHECK(e.values[0] >= e.values[1]);
+	CHECK(e.values[1] >= e.values[2]);
+	const auto RD = R*uv::float33(e.values)*transpose(R);
+
+	const auto d = svd(m);
+	const auto USV = matrix(d.u)*uv::float33(d.sigma)*transpose(matrix(d.v));
+	CHECK(d.sigma[0] >= abs(d.sigma[1]));
+	CHECK(d.sigma[1] >= abs(d.sigma[2]));
+
+	for (size_t i = 0; i < 3; ++i)
+	{
+		CHECK_APPROX(rows(RD)[i] == rows(s)[i]);
+		CHECK_APPROX(rows(USV)[i] == rows(m)[i]);
+	}
+
+	// a different matrix in every lane, over a full group and a partial one
+	std::vector<uv::float33> ms(11), ss(ms.size());
+	for (size_t k = 0; k < ms.size(); ++k)
+	{
+		for (size_t i = 0; i < 3; ++i)
+			cols(ms[k])[i] = uv::vector(signed_unit_float(), signed_unit_float(), signed_unit_float());
+		ss[k] = ms[k]*transpose(ms[k]) + uv::float33(signed_unit_float());
+	}
+	std::vector<uv::floatq> u(ms.size()), v(ms.size()), vectors(ms.size());
+	std::vector<uv::float3> sigma(ms.size()), values(ms.size());
+	svd(gsl::span<const uv::float33>(ms.data(), ms.size()), gsl::make_span(u), gsl::make_span(sigma), gsl::make_span(v));
+	eigen(gsl::span<const uv::float33>(ss.data(), ss.size()), gsl::make_span(vectors), gsl::make_span(values));
+	for (size_t k = 0; k < ms.size(); ++k)
+	{
+		const auto dk = svd(ms[k]);
+		const auto ek = eigen(ss[k]);
+		const auto Rk = matrix(rotation(vectors[k]));
+		const auto USVk = matrix(rotation(u[k]))*uv::float33(sigma[k])*transpose(matrix(rotation(v[k])));
+		const auto RDk = Rk*uv::float33(values[k])*transpose(Rk);
+		CHECK_APPROX(sigma[k] == dk.sigma);
+		CHECK_APPROX(values[k] == ek.values);
+		for (size_t i = 0; i < 3; ++i)
+		{
+			CHECK_APPROX(rows(USVk)[i] == rows(ms[k])[i]);
+			CHECK_APPROX(rows(RDk)[i] == rows(ss[k])[i]);
+		}
+	}
+}
+void test_eigen(const uv::Vec<units::Distance<float>, 4>&, const uv::Vec<units::Distance<float>, 4>&)
+{
+}
+
+void test_simd(const uv::Vec<float, 4>& a, const uv::Vec<float, 4>& b)
+{
+	const uv::simd::float4 pa = a, pb = b;
+	CHECK(uv::float4(pa + pb) == a + b);
+	CHECK(uv::float4(pa - pb) == a - b);
+	CHECK(uv::float4(pa * pb) == a * b);
+	CHECK(uv::float4(pa / pb) == a / b);
+	CHECK(uv::float4(min(pa, pb)) == min(a, b));
+	CHECK(uv::float4(ifelse(pa < pb, pa, pb)) == ifelse(a < b, a, b));
+	CHECK(uv::bool4(pa < pb) == (a < b));
+	CHECK_APPROX(dot(pa, pb) == dot(a, b));
+
+	const uv::simd::float3 qa = a[XYZ], qb = b[XYZ];
+	CHECK_APPROX(uv::float3(cross(qa, qb)) == cross(a[XYZ], b[XYZ]));
+	CHECK_APPROX(dot(qa, qb) == dot(a[XYZ], b[XYZ]));
+	CHECK(uv::float3(qa / qb) == a[XYZ] / b[XYZ]);
+
+	uv::float44 m;
+	for (size_t i = 0; i < 4; ++i)
+		cols(m)[i] = uv::vector(signed_unit_float(), signed_unit_float(), signed_unit_float(), signed_unit_float());
+	std::vector<uv::float4> vs = { a, b, a - b };
+	transform(m, gsl::span<const uv::float4>(vs.data(), vs.size()), gsl::span<uv::float4>(vs.data(), vs.size()));
+	CHECK_APPROX(vs[0] == cols(m)[0]*a[0] + cols(m)[1]*a[1] + cols(m)[2]*a[2] + cols(m)[3]*a[3]);
+	CHECK_APPROX(vs[1] == m*b);
+	CHECK_APPROX(vs[2] == m*(a - b));
+
+#ifdef __AVX__
+	const uv::double4 da = a, db = b;
+	const uv::simd::double4 pda = da, pdb = db;
+	CHECK(uv::double4(pda + pdb) == da + db);
+	CHECK(uv::double4(pda - pdb) == da - db);
+	CHECK(uv::double4(pda * pdb) == da * db);
+	CHECK(uv::double4(pda / pdb) == da / db);
+	CHECK(uv::double4(min(pda, pdb)) == min(da, db));
+	CHECK(uv::double4(ifelse(pda < pdb, pda, pdb)) == ifelse(da < db, da, db));
+	CHECK_APPROX(dot(pda, pdb) == dot(da, db));
+
+	const uv::simd::bool4d less = pda < pdb, more = pda > pdb;
+	CHECK(uv::bool4(less) == (da < db));
+	CHECK(uv::bool4(!less) == !(da < db));
+	CHECK(uv::bool4(less | more) == (da != db));
+	CHECK(!any(less & more));
+	CHECK(all(pda == pda));
+	CHECK(any(less) == any(da < db));
+
+	const uv::simd::double3 qda = da[XYZ], qdb = db[XYZ];
+	CHECK_APPROX(uv::double3(cross(qda, qdb)) == cross(da[XYZ], db[XYZ]));
+	CHECK_APPROX(dot(qda, qdb) == dot(da[XYZ], db[XYZ]));
+	CHECK(uv::double3(qda / qdb) == da[XYZ] / db[XYZ]);
+	CHECK(uv::Vec<bool, 3>(qda <= qdb) == (da[XYZ] <= db[XYZ]));
+#endif
+}
+void test_simd(const uv::Vec<units::Distance<float>, 4>&, const uv::Vec<units::Distance<float>, 4>&)
+{
+}
+
+
+template <class T>
+void test_ray()
+{
+	using U = uv::type::identity<T>;
+	const uv::Ray3<T> axis(uv::vector<T>(0, 0, 0), uv::vector<U>(1, 0, 0));
+	const auto unit = bounds(uv::vector<T>(1, -1, -1), uv::vector<T>(2, 1, 1));
+	CHECK(min(intersect(axis, unit)) == T(1));
+	CHECK(max(intersect(axis, unit)) == T(2));
+	CHECK(max(intersect(axis, unit + uv::vector<T>(-3, 0, 0))) < min(intersect(axis, unit + uv::vector<T>(-3, 0, 0))));
+	CHECK(axis(T(2)) == uv::vector<T>(2, 0, 0));
+
+	std::vector<uv::Bounds3<T>> boxes(37);
+	for (auto& box : boxes)
+	{
+		const auto c = uv::vector<T>(signed_unit_float(), signed_unit_float(), signed_unit_float()) * 10;
+		const auto e = uv::vector<T>(std::abs(signed_unit_float()), std::abs(signed_unit_float()), std::abs(signed_unit_float())) * 4;
+		box = bounds(c - e, c + e);
+	}
+	boxes[5] = uv::Bounds3<T>(uv::empty);
+	const uv::Bounds3SoA<T> soa(gsl::span<const uv::Bounds3<T>>(boxes.data(), boxes.size()));
+	CHECK(soa.size() == boxes.size());
+	CHECK(min(soa[3]) == min(boxes[3]) && max(soa[3]) == max(boxes[3]));
+	CHECK(!(min(soa[5])[0] < max(soa[5])[0]));
+
+	const uv::Ray3<T> ray(uv::vector<T>(signed_unit_float(), signed_unit_float(), signed_unit_float()) * 20,
+		uv::vector<U>(signed_unit_float(), signed_unit_float(), signed_unit_float()));
+	const T tmax = T(30);
+	std::vector<T> entry(boxes.size());
+	bool hit[37];
+	const size_t hits = intersect(ray, soa, tmax, gsl::span<T>(entry.data(), entry.size()), gsl::span<bool>(hit, 37));
+	size_t expected = 0;
+	for (size_t i = 0; i < boxes.size(); ++i)
+	{
+		const auto range = intersect(ray, boxes[i]);
+		const bool inside = !(max(range) < min(range)) && !(tmax < min(range));
+		expected += inside;
+		CHECK(hit[i] == inside);
+		if (inside)
+		{
+			CHECK(entry[i] == min(range));
+			const auto p = ray(entry[i]);
+			const T eps = T(1e-3);
+			for (size_t k = 0; k < 3; ++k)
+				CHECK(!(p[k] < min(boxes[i][k]) - eps) && !(max(boxes[i][k]) + eps < p[k]));
+		}
+	}
+	CHECK(hit[5] == false);
+	CHECK(hits == expected);
+}
+
+template <class T>
+void test_frustum()
+{
+	using U = uv::type::identity<T>;
+	const auto p = uv::plane(uv::direction(uv::vector<U>(0, 0, 2)), uv::vector<T>(1, 2, 3));
+	CHECK(distance(p, uv::vector<T>(5, 5, 5)) == T(2));
+	CHECK(distance(-p, uv::vector<T>(5, 5, 5)) == T(-2));
+	CHECK(uv::plane(uv::vector<T>(0, 0, 1), uv::vector<T>(1, 0, 1), uv::vector<T>(0, 1, 1)).normal[2] == U(1));
+
+	// 90 degree field of view with near and far planes at 1 and 100, looking down -z
+	const U n = 1, f = 100;
+	const auto projection = uv::rows(
+		uv::vector<U>(1, 0, 0, 0),
+		uv::vector<U>(0, 1, 0, 0),
+		uv::vector<U>(0, 0, -(f + n)/(f - n), -2*f*n/(f - n)),
+		uv::vector<U>(0, 0, -1, 0));
+	const uv::Frustum<T> frustum(projection);
+	const auto cube = [](const uv::Vec3<T>& c, T e) { return bounds(c - e, c + e); };
+	CHECK(!culled(frustum, cube(uv::vector<T>(0, 0, -10), T(1))));
+	CHECK(culled(frustum, cube(uv::vector<T>(0, 0, 10), T(1))));
+	CHECK(culled(frustum, cube(uv::vector<T>(50, 0, -10), T(1))));
+	CHECK(culled(frustum, cube(uv::vector<T>(0, 0, -110), T(1))));
+	CHECK(!culled(frustum, cube(uv::vector<T>(0, 0, -100), T(1))));
+	CHECK(culled(frustum, uv::Bounds3<T>(uv::empty)));
+
+	std::vector<uv::Bounds3<T>> boxes(150);
+	for (auto& box : boxes)
+		box = cube(uv::vector<T>(signed_unit_float(), signed_unit_float(), signed_unit_float()) * 60, T(std::abs(signed_unit_float()) * 5));
+	boxes[70] = uv::Bounds3<T>(uv::empty);
+	std::vector<uint32_t> visible(boxes.size()), expected;
+	const size_t count = cull(frustum, gsl::span<const uv::Bounds3<T>>(boxes.data(), boxes.size()), gsl::span<uint32_t>(visible.data(), visible.size()));
+	visible.resize(count);
+	for (size_t i = 0; i < boxes.size(); ++i)
+	{
+		if (!culled(frustum, boxes[i]))
+			expected.push_back(uint32_t(i));
+		else if (i != 70)
+		{
+			// then all corners are behind one plane, the one the farthest corner is least in front of
+			const auto farthest = [&](const uv::Plane<T>& plane)
+			{
+				T d = distance(plane, uv::vector<T>(min(boxes[i][0]), min(boxes[i][1]), min(boxes[i][2])));
+				for (size_t corner = 1; corner < 8; ++corner)
+				{
+					const auto x = uv::vector<T>(corner & 1 ? max(boxes[i][0]) : min(boxes[i][0]), corner & 2 ? max(boxes[i][1]) : min(boxes[i][1]), corner & 4 ? max(boxes[i][2]) : min(boxes[i][2]));
+					d = std::max(d, distance(plane, x));
+				}
+				return d;
+			};
+			T behind = farthest(frustum.planes[0]);
+			for (const auto& plane : frustum.planes)
+				behind = std::min(behind, farthest(plane));
+			CHECK(behind < T(1e-4));
+		}
+	}
+	CHECK(!expected.empty());
+	CHECK(visible == expected);
+}
+
+template <class T>
+void test_bvh()
+{
+	static_assert(sizeof(uv::Bvh<float>::Node) == 32);
+	static_assert(sizeof(uv::Bvh<double>::Node) == 64);
+
+	const auto random_box = []
+	{
+		const auto c = uv::vector<T>(signed_unit_float(), signed_unit_float(), signed_unit_float()) * 10;
+		const auto e = uv::vector<T>(std::abs(signed_unit_float()), std::abs(signed_unit_float()), std::abs(signed_unit_float()));
+		return bounds(c - e, c + e);
+	};
+	std::vector<uv::Bounds3<T>> boxes(200);
+	for (auto& box : boxes)
+		box = random_box();
+
+	const auto check_overlap = [&](const uv::Bvh<T>& bvh)
+	{
+		const auto query = random_box();
+		std::vector<size_t> found, expected;
+		bvh.overlap(query, [&](size_t i) { found.push_back(i); });
+		for (size_t i = 0; i < boxes.size(); ++i)
+			if (intersect(boxes[i][0], query[0]) && intersect(boxes[i][1], query[1]) && intersect(boxes[i][2], query[2]))
+				expected.push_back(i);
+		std::sort(found.begin(), found.end());
+		CHECK(found == expected);
+	};
+	const auto check_raycast = [&](const uv::Bvh<T>& bvh)
+	{
+		const auto origin = uv::vector<T>(signed_unit_float(), signed_unit_float(), signed_unit_float()) * 20;
+		const uv::Ray3<T> ray(origin, uv::vector<uv::type::identity<T>>(signed_unit_float(), signed_unit_float(), signed_unit_float()));
+		T hit = T(100), expected = T(100), t;
+		bvh.raycast(ray, T(100), [&](size_t i, T& tmax)
+		{
+			if (uv::details::enters(ray, boxes[i], tmax, t))
+				hit = tmax = t;
+		});
+		for (const auto& box : boxes)
+			if (uv::details::enters(ray, box, expected, t))
+				expected = t;
+		CHECK(hit == expected);
+		// without a limit, exactly the boxes the ray hits are reported
+		std::vector<size_t> found, hits;
+		bvh.raycast(ray, std::numeric_limits<T>::infinity(), [&](size_t i, T&) { found.push_back(i); });
+		for (size_t i = 0; i < boxes.size(); ++i)
+			if (intersect(ray, boxes[i]))
+				hits.push_back(i);
+		std::sort(found.begin(), found.end());
+		CHECK(found == hits);
+	};
+
+	uv::Bvh<T> bvh(gsl::span<const uv::Bounds3<T>>(boxes.data(), boxes.size()));
+	std::vector<size_t> seen(boxes.size());
+	for (const auto& node : bvh.nodes())
+	{
+		CHECK(!(node.count > uv::Bvh<T>::max_leaf_size));
+		for (size_t j = node.offset; node.leaf() && j < node.offset + node.count; ++j)
+			++seen[bvh.indices()[j]];
+	}
+	for (const size_t n : seen)
+		CHECK(n == 1);
+	check_overlap(bvh);
+	check_raycast(bvh);
+
+	const auto shift = uv::vector<T>(signed_unit_float(), signed_unit_float(), signed_unit_float());
+	for (size_t i = 0; i < boxes.size(); i += 3)
+		boxes[i] = bounds(min(boxes[i]) + shift, max(boxes[i]) + shift);
+	bvh.refit(gsl::span<const uv::Bounds3<T>>(boxes.data(), boxes.size()));
+	check_overlap(bvh);
+	check_raycast(bvh);
+}
+
+template <class T>
+void test_reduce()
+{
+	std::vector<uv::Point3<T>> cloud(3*uv::details::reduce_chunk + 77);
+	for (auto& p : cloud)
+		p = uv::Point3<T>(T(signed_unit_float()) * 100 + T(1000), T(signed_unit_float()), T(signed_unit_float()) * 3);
+	cloud[12345].v[1] = T(7);
+	const gsl::span<const uv::Point3<T>> points(cloud.data(), cloud.size());
+
+	double expected[3] = {};
+	auto box = bounds(cloud[0].v);
+	for (const auto& p : cloud)
+	{
+		box = bounds(box, p.v);
+		for (size_t k = 0; k < 3; ++k)
+			expected[k] += double(p.v[k] / T(1));
+	}
+	const auto total = sum(points);
+	for (size_t k = 0; k < 3; ++k)
+		CHECK(std::abs(double(total[k] / T(1)) - expected[k]) < 1e-5 * (std::abs(expected[0]) + 1));
+	CHECK(min(bounds(points)) == min(box));
+	CHECK(max(bounds(points)) == max(box));
+	CHECK(max(bounds(points))[1] == T(7));
+	CHECK(mean(points).v == total / float(cloud.size()));
+
+	// the same additions in the same order, whatever the number of threads
+	for (size_t threads : { 1, 2, 3, 5 })
+		CHECK(all(uv::details::sum_points(points, threads) == total));
+
+	const gsl::span<const uv::Point3<T>> none(cloud.data(), size_t(0));
+	CHECK(all(sum(none) == uv::Vec3<T>(T(0))));
+	CHECK(!(min(bounds(none))[0] < max(bounds(none))[0]));
+}
+
+template <class T>
+void test_stats()
+{
+	using M = uv::type::mul<T>;
+	std::vector<uv::Point3<T>> cloud(1000);
+	for (auto& p : cloud)
+		p = uv::Point3<T>(T(signed_unit_float()) * 4 + T(5000), T(signed_unit_float()), T(signed_unit_float() * signed_unit_float()));
+
+	uv::PointStats3<T> one, batch, left, right;
+	for (const auto& p : cloud)
+		one.add(p);
+	batch.add(gsl::span<const uv::Point3<T>>(cloud.data(), 333));
+	batch.add(gsl::span<const uv::Point3<T>>(cloud.data() + 333, cloud.size() - 333));
+	for (size_t i = 0; i < cloud.size(); ++i)
+		(i < 600 ? left : right).add(cloud[i]);
+	left.merge(right);
+
+	// two-pass reference in double
+	double mean[3] = {}, cov[3][3] = {};
+	for (const auto& p : cloud)
+		for (size_t k = 0; k < 3; ++k)
+			mean[k] += double(p.v[k] / T(1)) / cloud.size();
+	for (const auto& p : cloud)
+		for (size_t r = 0; r < 3; ++r)
+			for (size_t c = 0; c < 3; ++c)
+				cov[r][c] += (double(p.v[r] / T(1)) - mean[r]) * (double(p.v[c] / T(1)) - mean[c]) / cloud.size();
+
+	auto box = bounds(cloud[0].v);
+	for (const auto& p : cloud)
+		box = bounds(box, p.v);
+
+	for (const auto* s : { &one, &batch, &left })
+	{
+		CHECK(s->count() == cloud.size());
+		CHECK(min(s->bounds()) == min(box));
+		CHECK(max(s->bounds()) == max(box));
+		const auto c = s->covariance();
+		for (size_t r = 0; r < 3; ++r)
+		{
+			CHECK(std::abs(double(s->mean().v[r] / T(1)) - mean[r]) < 1e-6 * (std::abs(mean[r]) + 1));
+			for (size_t k = 0; k < 3; ++k)
+			{
+				CHECK(std::abs(double(rows(c)[r][k] / M(1)) - cov[r][k]) < 1e-4 * std::sqrt(cov[r][r] * cov[k][k]));
+				CHECK(rows(c)[r][k] == rows(c)[k][r]);
+			}
+		}
+	}
+
+	uv::PointStats3<T> none;
+	none.merge(uv::PointStats3<T>());
+	CHECK(none.count() == 0);
+	CHECK(rows(none.covariance())[0][0] == M(0));
+	none.merge(one);
+	CHECK(none.count() == cloud.size());
+}
+
+template <class T>
+void test_morton()
+{
+	const auto unit = uv::bounds(uv::vector<T>(0, 0, 0), uv::vector<T>(1, 1, 1));
+	const T cell = T(1.5f / 1024);
+	CHECK(uv::morton_code(uv::Point3<T>(cell, T(0), T(0)), unit) == 1u);
+	CHECK(uv::morton_code(uv::Point3<T>(T(0), cell, T(0)), unit) == 2u);
+	CHECK(uv::morton_code(uv::Point3<T>(T(0), T(0), cell), unit) == 4u);
+	CHECK(uv::morton_code(uv::Point3<T>(T(1), T(1), T(1)), unit) == (1u << 30) - 1);
+	CHECK(uv::morton_code(uv::Point3<T>(T(-5), T(9), T(0.5f)), unit) == uv::morton_code(uv::Point3<T>(T(0), T(1), T(0.5f)), unit));
+	CHECK(uv::morton_code<uint64_t>(uv::Point3<T>(T(1), T(1), T(1)), unit) == (uint64_t(1) << 63) - 1);
+
+	// against bit-by-bit interleaving
+	Repeat(100) << [&]
+	{
+		const auto q = uv::vector(uint32_t(rand()) & 0x1fffff, uint32_t(rand()) & 0x1fffff, uint32_t(rand()) & 0x1fffff);
+		uint64_t expected = 0;
+		for (size_t b = 0; b < 21; ++b)
+			for (size_t k = 0; k < 3; ++k)
+				expected |= uint64_t((q[k] >> b) & 1) << (3*b + k);
+		CHECK(uv::details::interleave<uint64_t, 3>(q) == expected);
+		CHECK(uv::details::interleave<uint32_t, 3>(uv::vector(q[0] & 0x3ff, q[1] & 0x3ff, q[2] & 0x3ff)) == uint32_t(expected & 0x3fffffff));
+	};
+
+	// the Hilbert curve visits every cell once, moving to a neighbour at each step
+	const uint32_t bits = 3, side = 1 << bits;
+	std::vector<uv::Vec<uint32_t, 3>> path(side*side*side, uv::Vec<uint32_t, 3>(side));
+	for (uint32_t x = 0; x < side; ++x)
+		for (uint32_t y = 0; y < side; ++y)
+			for (uint32_t z = 0; z < side; ++z)
+				path[uv::details::hilbert_index<uint32_t, 3>(uv::vector(x, y, z), bits)] = uv::vector(x, y, z);
+	for (size_t i = 1; i < path.size(); ++i)
+	{
+		int steps = 0;
+		for (size_t k = 0; k < 3; ++k)
+			steps += std::abs(int(path[i][k]) - int(path[i - 1][k]));
+		CHECK(steps == 1);
+	}
+	std::vector<uv::Vec<uint32_t, 2>> path2(side*side, uv::Vec<uint32_t, 2>(side));
+	for (uint32_t x = 0; x < side; ++x)
+		for (uint32_t y = 0; y < side; ++y)
+			path2[uv::details::hilbert_index<uint32_t, 2>(uv::vector(x, y), bits)] = uv::vector(x, y);
+	for (size_t i = 1; i < path2.size(); ++i)
+		CHECK(std::abs(int(path2[i][0]) - int(path2[i - 1][0])) + std::abs(int(path2[i][1]) - int(path2[i - 1][1])) == 1);
+
+	// radix sort is stable and moves the payload along
+	std::vector<uint32_t> codes(3*uv::details::radix_chunk + 11), payload(codes.size());
+	std::vector<std::pair<uint32_t, uint32_t>> expected(codes.size());
+	for (size_t i = 0; i < codes.size(); ++i)
+	{
+		codes[i] = uint32_t(rand()) & 0xfff0ff;
+		payload[i] = uint32_t(i);
+		expected[i] = { codes[i], uint32_t(i) };
+	}
+	std::stable_sort(expected.begin(), expected.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+	uv::radix_sort(gsl::span<uint32_t>(codes.data(), codes.size()), gsl::span<uint32_t>(payload.data(), payload.size()));
+	for (size_t i = 0; i < codes.size(); ++i)
+	{
+		CHECK(codes[i] == expected[i].first);
+		CHECK(payload[i] == expected[i].second);
+	}
+
+	std::vector<uv::Point3<T>> cloud(5000);
+	std::vector<int> ids(cloud.size());
+	for (size_t i = 0; i < cloud.size(); ++i)
+	{
+		cloud[i] = uv::Point3<T>(T(signed_unit_float()), T(signed_unit_float()) * 10, T(signed_unit_float()));
+		ids[i] = int(i);
+	}
+	const auto original = cloud;
+	uv::morton_sort(gsl::span<uv::Point3<T>>(cloud.data(), cloud.size()), gsl::span<int>(ids.data(), ids.size()));
+	const auto domain = bounds(gsl::span<const uv::Point3<T>>(cloud.data(), cloud.size()));
+	for (size_t i = 0; i < cloud.size(); ++i)
+	{
+		if (i > 0)
+			CHECK(uv::morton_code(cloud[i], domain) >= uv::morton_code(cloud[i - 1], domain));
+		CHECK(cloud[i].v == original[ids[i]].v);
+	}
+}
+
+template <class T>
+void test_kdtree()
+{
+	using M = uv::type::mul<T>;
+	using Tree = uv::KdTree3<T>;
+	std::vector<uv::Point3<T>> cloud(3000);
+	for (auto& p : cloud)
+		p = uv::Point3<T>(T(signed_unit_float()) * 10, T(signed_unit_float()) * 10, T(signed_unit_float()));
+	cloud[17] = cloud[18]; // duplicates must not break the splits
+	const auto original = cloud;
+	const Tree tree(gsl::span<uv::Point3<T>>(cloud.data(), cloud.size()));
+	CHECK(tree.size() == cloud.size());
+	for (size_t i = 0; i < cloud.size(); ++i)
+		CHECK(cloud[i].v == original[tree.index(i)].v);
+
+	std::vector<uv::Point3<T>> queries(20);
+	for (auto& q : queries)
+		q = uv::Point3<T>(T(signed_unit_float()) * 12, T(signed_unit_float()) * 12, T(signed_unit_float()) * 2);
+	const size_t k = 7;
+	std::vector<typename Tree::Neighbor> batch(queries.size() * k);
+	tree.nearest(gsl::span<const uv::Point3<T>>(queries.data(), queries.size()), k, gsl::span<typename Tree::Neighbor>(batch.data(), batch.size()));
+	for (size_t j = 0; j < queries.size(); ++j)
+	{
+		const auto& q = queries[j];
+		std::vector<M> d2(original.size());
+		for (size_t i = 0; i < original.size(); ++i)
+			d2[i] = square(original[i] - q);
+		auto sorted = d2;
+		std::sort(sorted.begin(), sorted.end());
+
+		typename Tree::Neighbor found[k];
+		CHECK(tree.nearest(q, gsl::span<typename Tree::Neighbor>(found, k)) == k);
+		for (size_t i = 0; i < k; ++i)
+		{
+			CHECK(found[i].distance2 == sorted[i]);
+			CHECK(d2[found[i].index] == found[i].distance2);
+			CHECK(batch[j*k + i].distance2 == sorted[i]);
+		}
+
+		const T r = T(2);
+		size_t inside = 0, reported = 0;
+		for (const auto& x : d2)
+			inside += !(r*r < x);
+		tree.radius(q, r, [&](size_t i, M distance2)
+		{
+			++reported;
+			CHECK(d2[i] == distance2);
+			CHECK(r*r >= distance2);
+		});
+		CHECK(reported == inside);
+	}
+
+	std::vector<uv::Point3<T>> few(3, uv::Point3<T>(T(1), T(2), T(3)));
+	const Tree small(gsl::span<uv::Point3<T>>(few.data(), few.size()));
+	typename Tree::Neighbor found[5];
+	CHECK(small.nearest(uv::Point3<T>(T(0), T(0), T(0)), gsl::span<typename Tree::Neighbor>(found, 5)) == 3);
+	const Tree none;
+	CHECK(none.nearest(uv::Point3<T>(T(0), T(0), T(0)), gsl::span<typename Tree::Neighbor>(found, 5)) == 0);
+}
+
+template <class T>
+void test_hashgrid()
+{
+	using M = uv::type::mul<T>;
+	std::unordered_map<uv::Vec<int, 3>, int> map;
+	for (int i = 0; i < 100; ++i)
+		map[uv::Vec<int, 3>(i % 5, i / 5 % 5, i / 25)] = i;
+	CHECK(map.size() == 100);
+	CHECK(map[uv::Vec<int, 3>(1, 2, 3)] == 1 + 2*5 + 3*25);
+	CHECK(std::hash<uv::Point<int, 3>>()(uv::point(uv::Vec<int, 3>(1, 2, 3))) == std::hash<uv::Vec<int, 3>>()(uv::Vec<int, 3>(1, 2, 3)));
+
+	std::vector<uv::Point3<T>> cloud(3000);
+	for (auto& p : cloud)
+		p = uv::Point3<T>(T(signed_unit_float()) * 10, T(signed_unit_float()) * 10, T(signed_unit_float()));
+	cloud[17] = cloud[18];
+	const T h = T(1.5);
+	uv::HashGrid3<T> grid(h);
+	// the second build reuses the storage of the first
+	grid.build(gsl::span<const uv::Point3<T>>(cloud.data(), 100));
+	grid.build(gsl::span<const uv::Point3<T>>(cloud.data(), cloud.size()));
+	CHECK(grid.size() == cloud.size());
+	size_t counted = 0;
+	for (uint32_t c = 0; c < grid.cells(); ++c)
+	{
+		const auto points = grid.points(c);
+		const auto indices = grid.indices(c);
+		counted += points.size();
+		for (size_t i = 0; i < size_t(points.size()); ++i)
+		{
+			CHECK(points[i].v == cloud[indices[i]].v);
+			CHECK(grid.cell(points[i]) == c);
+			CHECK(grid.cell_of(indices[i]) == c);
+		}
+	}
+	CHECK(counted == cloud.size());
+	CHECK(grid.cell(uv::Point3<T>(T(100), T(0), T(0))) == uv::HashGrid3<T>::no_cell);
+	CHECK(all(grid.key(uv::Point3<T>(T(-0.1), T(0.1), T(3))) == uv::Vec<int32_t, 3>(-1, 0, 2)));
+
+	Repeat(20) << [&]
+	{
+		const auto q = uv::Point3<T>(T(signed_unit_float()) * 12, T(signed_unit_float()) * 12, T(signed_unit_float()) * 2);
+		for (const T r : { h, T(0.5) })
+		{
+			size_t inside = 0, reported = 0;
+			for (const auto& p : cloud)
+				inside += !(r*r < square(p - q));
+			grid.neighbors(q, r, [&](size_t i, M distance2)
+			{
+				++reported;
+				CHECK(square(cloud[i] - q) == distance2);
+				CHECK(r*r >= distance2);
+			});
+			CHECK(reported == inside);
+		}
+	};
+
+	uv::HashGrid3<T> none(h);
+	CHECK(none.cell(uv::Point3<T>(T(0), T(0), T(0))) == uv::HashGrid3<T>::no_cell);
+	none.build(gsl::span<const uv::Point3<T>>(cloud.data(), size_t(0)));
+	CHECK(none.cells() == 0);
+	size_t reported = 0;
+	none.neighbors(uv::Point3<T>(T(0), T(0), T(0)), [&](size_t, M) { ++reported; });
+	CHECK(reported == 0);
+}
+
+template <class T>
+void test_aabbtree()
+{
+	using Tree = uv::AabbTree<T>;
+	const auto random_box = [](float scale)
+	{
+		const auto c = uv::vector(T(signed_unit_float()), T(signed_unit_float()), T(signed_unit_float())) * 20;
+		const auto e = uv::vector(T(std::abs(signed_unit_float())), T(std::abs(signed_unit_float())), T(std::abs(signed_unit_float()))) * scale;
+		return uv::bounds(c - e, c + e);
+	};
+	const T margin = T(0.25);
+	Tree tree(margin);
+	std::vector<uint32_t> proxies;
+	std::vector<uv::Bounds3<T>> boxes;
+	for (size_t i = 0; i < 600; ++i)
+	{
+		boxes.push_back(random_box(1));
+		proxies.push_back(tree.insert(boxes.back()));
+	}
+	CHECK(tree.size() == proxies.size());
+	// rotations keep the tree within a small factor of the balanced height
+	CHECK(tree.height() < 24);
+
+	const auto brute = [&](const std::vector<uint32_t>& changed)
+	{
+		std::set<std::pair<uint32_t, uint32_t>> expected;
+		for (const uint32_t a : changed)
+			for (const uint32_t b : proxies)
+				if (a != b && bool(intersect(tree.fat(a), tree.fat(b))))
+					expected.insert({ std::min(a, b), std::max(a, b) });
+		return expected;
+	};
+	std::set<std::pair<uint32_t, uint32_t>> found;
+	const auto collect = [&](uint32_t a, uint32_t b)
+	{
+		CHECK(a < b);
+		CHECK(found.insert({ a, b }).second);
+	};
+	tree.pairs(collect);
+	CHECK(found == brute(proxies));
+
+	// nothing changed, so there is nothing to report
+	found.clear();
+	tree.pairs(collect);
+	CHECK(found.empty());
+
+	std::vector<uint32_t> changed;
+	for (size_t i = 0; i < proxies.size(); i += 3)
+	{
+		// small moves stay inside the fat bounds, large ones reinsert
+		const auto d = uv::vector(T(signed_unit_float()), T(signed_unit_float()), T(signed_unit_float())) * (i % 2 ? 0.1f : 2.f);
+		boxes[i] = uv::bounds(min(boxes[i]) + d, max(boxes[i]) + d);
+		if (tree.move(proxies[i], boxes[i], d))
+			changed.push_back(proxies[i]);
+	}
+	for (size_t i = 0; i < proxies.size(); ++i)
+	{
+		CHECK(min(boxes[i]) >= min(tree.fat(proxies[i])));
+		CHECK(max(tree.fat(proxies[i])) >= max(boxes[i]));
+	}
+	CHECK(!changed.empty());
+	CHECK(changed.size() < proxies.size() / 3);
+	found.clear();
+	tree.pairs(collect);
+	CHECK(found == brute(changed));
+
+	// removal frees nodes for reuse and takes removed proxies out of pending pairs
+	for (size_t i = 0; i < 200; ++i)
+	{
+		tree.move(proxies[i], random_box(1));
+		tree.remove(proxies[i]);
+	}
+	proxies.erase(proxies.begin(), proxies.begin() + 200);
+	boxes.erase(boxes.begin(), boxes.begin() + 200);
+	CHECK(tree.size() == proxies.size());
+	changed.clear();
+	for (size_t i = 0; i < 50; ++i)
+	{
+		boxes.push_back(random_box(1));
+		proxies.push_back(tree.insert(boxes.back()));
+		changed.push_back(proxies.back());
+	}
+	CHECK(*std::max_element(proxies.begin(), proxies.end()) < 2*600);
+	found.clear();
+	tree.pairs(collect);
+	CHECK(found == brute(changed));
+
+	const auto query = random_box(5);
+	size_t reported = 0, expected = 0;
+	tree.overlap(query, [&](uint32_t) { ++reported; });
+	for (const uint32_t p : proxies)
+		expected += bool(intersect(tree.fat(p), query));
+	CHECK(reported == expected);
+
+	for (const uint32_t p : proxies)
+		tree.remove(p);
+	CHECK(tree.size() == 0);
+	CHECK(tree.height() == -1);
+}
+
+template <class T>
+void test_octree()
+{
+	using Tree = uv::Octree<T>;
+	using Field = typename Tree::Field;
+	std::vector<uv::Point3<T>> bodies(2000);
+	std::vector<float> masses(bodies.size());
+	for (size_t i = 0; i < bodies.size(); ++i)
+	{
+		// a dense clump inside a sparse cloud, so the tree has both deep and shallow leaves
+		const float scale = i % 4 ? 10.f : 0.5f;
+		bodies[i] = uv::Point3<T>(T(signed_unit_float() * scale), T(signed_unit_float() * scale), T(signed_unit_float() * scale));
+		masses[i] = 1 + std::abs(signed_unit_float());
+	}
+	bodies[17] = bodies[18];
+	const Tree tree(gsl::span<const uv::Point3<T>>(bodies.data(), bodies.size()), gsl::span<const float>(masses.data(), masses.size()));
+	CHECK(tree.size() == bodies.size());
+
+	const auto& nodes = tree.nodes();
+	const auto& root = nodes[0];
+	CHECK(root.count == bodies.size());
+	CHECK(nodes.back().next == nodes.size());
+	float total = 0;
+	for (const float m : masses)
+		total += m;
+	CHECK(std::abs(root.mass - total) < 1e-3f * total);
+	const auto box = uv::bounds(gsl::span<const uv::Point3<T>>(bodies.data(), bodies.size()));
+	CHECK(all(min(root.box) == min(box)));
+	CHECK(all(max(root.box) == max(box)));
+	for (size_t i = 0; i < nodes.size(); ++i)
+	{
+		for (uint32_t j = nodes[i].first; j < nodes[i].first + nodes[i].count; ++j)
+		{
+			CHECK(tree.points()[j].v >= min(nodes[i].box));
+			CHECK(max(nodes[i].box) >= tree.points()[j].v);
+		}
+		CHECK(nodes[i].center.v >= min(nodes[i].box));
+		CHECK(max(nodes[i].box) >= nodes[i].center.v);
+		if (nodes[i].next != i + 1)
+		{
+			const auto& last = nodes[nodes[i].next - 1];
+			CHECK(nodes[i + 1].first == nodes[i].first);
+			CHECK(last.first + last.count == nodes[i].first + nodes[i].count);
+		}
+		else
+			CHECK(Tree::leaf_size >= nodes[i].count);
+	}
+
+	const auto direct = [&](const uv::Point3<T>& p)
+	{
+		uv::Vec3<Field> acc(Field(0));
+		for (size_t j = 0; j < bodies.size(); ++j)
+		{
+			const auto d = bodies[j] - p;
+			const auto r2 = square(d);
+			if (r2 > decltype(r2)(0))
+				acc = acc + d * (masses[j] / (r2 * T(sqrt(r2))));
+		}
+		return acc;
+	};
+	std::vector<uv::Vec3<Field>> approximate(bodies.size());
+	tree.field(gsl::span<uv::Vec3<Field>>(approximate.data(), approximate.size()), 0.5f);
+	for (size_t i = 0; i < bodies.size(); i += 37)
+	{
+		const auto expected = direct(bodies[i]);
+		tester::presicion = 1e-4f;
+		CHECK_APPROX(tree.field(bodies[i], 0.f) == expected);
+		tester::presicion = 5e-2f;
+		CHECK_APPROX(approximate[i] == expected);
+	}
+	tester::presicion = tester::default_float_presicion;
+	CHECK(all(approximate[42] == tree.field(bodies[42], 0.5f)));
+
+	// softening bounds the field of nearby bodies, and the field points towards the mass
+	std::vector<uv::Point3<T>> pair = { uv::Point3<T>(T(0), T(0), T(0)), uv::Point3<T>(T(1), T(0), T(0)) };
+	std::vector<float> unit = { 1, 1 };
+	const Tree two(gsl::span<const uv::Point3<T>>(pair.data(), pair.size()), gsl::span<const float>(unit.data(), unit.size()));
+	const auto f = two.field(pair[0], 0.5f);
+	CHECK(std::abs(f[0] * (T(1) * T(1)) - 1) < 1e-6f);
+	CHECK(two.field(pair[0], 0.5f, T(1) * T(1))[0] * (T(1) * T(1)) < 0.5f);
+
+	const Tree none(gsl::span<const uv::Point3<T>>(pair.data(), size_t(0)), gsl::span<const float>(unit.data(), size_t(0)));
+	CHECK(all(none.field(pair[0], 0.5f) == uv::Vec3<Field>(Field(0))));
+}
+
+void test_slerp()
+{
+	const auto random_rotation = [] { return rotation(uv::quaternion(signed_unit_float(), uv::vector(signed_unit_float(), signed_unit_float(), signed_unit_float()))); };
+	// the angle of the rotation from x to y, accurate for small angles too
+	const auto between = [](const uv::Rot3<float>& x, const uv::Rot3<float>& y)
+	{
+		const auto d = conjugate(quaternion(x)) * quaternion(y);
+		return 2 * std::atan2(float(length(d.im)), std::abs(d.re));
+	};
+	tester::presicion = 1e-4f;
+	float worst = 0;
+	Repeat(200) << [&]
+	{
+		const auto a = random_rotation(), b = random_rotation();
+		const auto minus_b = uv::Rot3<float>::fromUnchecked(-quaternion(b));
+		CHECK(between(slerp(a, b, 0.f), a) < 1e-5f);
+		CHECK(between(slerp(a, b, 1.f), b) < 1e-5f);
+		CHECK(between(fast_slerp(a, b, 0.f), a) < 1e-5f);
+		CHECK(between(fast_slerp(a, b, 1.f), b) < 1e-5f);
+		CHECK(between(nlerp(a, b, 0.f), a) < 1e-5f);
+		CHECK(between(nlerp(a, b, 1.f), b) < 1e-5f);
+		const float total = between(a, b);
+		for (const float t : { 0.1f, 0.25f, 0.5f, 0.7f, 0.95f })
+		{
+			const auto r = slerp(a, b, t);
+			CHECK_APPROX(between(a, r) == t*total);
+			CHECK_APPROX(between(r, b) == (1 - t)*total);
+			CHECK(between(r, slerp(a, minus_b, t)) < 1e-5f);
+			CHECK(between(fast_slerp(a, b, t), fast_slerp(a, minus_b, t)) < 1e-5f);
+			const float error = between(r, fast_slerp(a, b, t));
+			worst = std::max(worst, error);
+			CHECK(error < 1e-3f);
+			CHECK(between(r, interpolate(t, a, b)) < 1e-6f);
+		}
+		CHECK(between(nlerp(a, b, 0.5f), slerp(a, b, 0.5f)) < 1e-5f);
+	};
+	tester::presicion = tester::default_float_presicion;
+	CHECK(worst < 5e-5f);
+
+	uv::RotationTracksf tracks;
+	const float times[] = { 0, 1, 3, 4 };
+	std::vector<uv::Rot3<float>> keys;
+	for (int i = 0; i < 4; ++i)
+		keys.push_back(random_rotation());
+	const auto track = tracks.add(gsl::span<const float>(times, 4), gsl::span<const uv::Rot3<float>>(keys.data(), keys.size()));
+	const auto single = tracks.add(gsl::span<const float>(times, 1), gsl::span<const uv::Rot3<float>>(keys.data() + 2, 1));
+	for (int i = 0; i < 100; ++i)
+		tracks.add(gsl::span<const float>(times + 1, 3), gsl::span<const uv::Rot3<float>>(keys.data() + i % 2, 3));
+	CHECK(tracks.size() == 102);
+	CHECK(tracks.keys(track) == 4);
+
+	const auto expected = [&](float time)
+	{
+		if (!(time > times[0]))
+			return keys[0];
+		for (size_t k = 0; k + 1 < 4; ++k)
+			if (time < times[k + 1])
+				return fast_slerp(keys[k], keys[k + 1], (time - times[k]) / (times[k + 1] - times[k]));
+		return keys[3];
+	};
+	// forward in small steps, then back to the start and jumps forward and back
+	for (const float time : { -1.f, 0.f, 0.3f, 0.9f, 1.f, 1.5f, 2.5f, 3.f, 3.99f, 4.f, 5.f, 0.5f, 3.5f, 1.2f, 2.f })
+	{
+		CHECK(between(tracks.sample(track, time), expected(time)) < 1e-5f);
+		CHECK(between(tracks.sample(single, time), keys[2]) < 1e-5f);
+	}
+
+	std::vector<uv::Rot3<float>> sampled(tracks.size(), uv::Rot3<float>(uv::identity));
+	for (const float time : { 0.5f, 1.7f, 3.2f, 6.f, 2.f })
+	{
+		tracks.sample(time, gsl::span<uv::Rot3<float>>(sampled.data(), sampled.size()));
+		CHECK(between(sampled[track], expected(time)) < 1e-5f);
+		CHECK(between(sampled[single], keys[2]) < 1e-5f);
+		for (size_t i = 2; i < tracks.size(); ++i)
+			CHECK(between(sampled[i], tracks.sample(i, time)) < 1e-5f);
+	}
+}
+
+template <class T>
+void test_dualquat()
+{
+	using U = uv::type::identity<T>;
+	using DQ = uv::DualQuat<T>;
+	const auto random_point = [] { return uv::Point3<T>(T(signed_unit_float() * 10), T(signed_unit_float() * 10), T(signed_unit_float() * 10)); };
+	const auto random_transform = [&]
+	{
+		const auto r = rotation(uv::quaternion(signed_unit_float(), uv::vector(signed_unit_float(), signed_unit_float(), signed_unit_float())));
+		return uv::Trans3<T>(r, random_point().v);
+	};
+	// points are compared relative to their length, which is up to about 17 here
+	tester::presicion = 1e-4f;
+	Repeat(100) << [&]
+	{
+		const auto a = random_transform(), b = random_transform();
+		const auto p = random_point();
+		const DQ da(a), db(b);
+		CHECK_APPROX((da*p).v == (a*p).v);
+		CHECK_APPROX((uv::Trans3<T>(da)*p).v == (a*p).v);
+		CHECK_APPROX(da*(p - b*p) == a.r*(p - b*p));
+		CHECK_APPROX(translation(da) == a.t);
+		CHECK_APPROX(((da*db)*p).v == ((a*b)*p).v);
+		CHECK_APPROX((invert(da)*(da*p)).v == p.v);
+		CHECK(std::abs(float(length(da.real)) - 1) < 1e-5f);
+		CHECK(std::abs(float(dot(da.real, da.dual) / T(1))) < 1e-4f);
+	};
+
+	Repeat(100) << [&]
+	{
+		const DQ a(random_transform()), b(random_transform());
+		const auto p = random_point();
+		CHECK_APPROX((blend(a, b, U(0))*p).v == (a*p).v);
+		CHECK_APPROX((blend(a, b, U(1))*p).v == (b*p).v);
+		// the same transform from either sign of quaternion, and at any weight
+		CHECK_APPROX((blend(a, -a, U(0.3f))*p).v == (a*p).v);
+		CHECK_APPROX((blend(a, a*U(2), U(0.7f))*p).v == (a*p).v);
+		const auto c = blend(a, b, U(0.4f));
+		CHECK(std::abs(float(length(c.real)) - 1) < 1e-5f);
+		CHECK(std::abs(float(dot(c.real, c.dual) / T(1))) < 1e-4f);
+		CHECK_APPROX((blend(a, -b, U(0.4f))*p).v == (c*p).v);
+		// blending rotations about the same axis through the same point turns around that axis
+		const auto turn = DQ(uv::Trans3<T>(rotation(uv::quaternion(0.6f, uv::vector(0.8f, 0.f, 0.f))), uv::vector(T(0), T(2), T(0))));
+		const auto half = blend(DQ(uv::identity), turn, U(0.5f));
+		CHECK_APPROX((half*(half*p)).v == (turn*p).v);
+	};
+
+	const size_t joints = 12, vertices = 1000;
+	std::vector<DQ> pose;
+	for (size_t j = 0; j < joints; ++j)
+		pose.push_back(j % 3 ? DQ(random_transform()) : -DQ(random_transform()));
+	uv::SkinWeights<U> weights;
+	uv::VecArray<T, 3> positions;
+	uv::VecArray<U, 3> normals;
+	for (size_t i = 0; i < vertices; ++i)
+	{
+		const uint32_t first = uint32_t(i % joints);
+		weights.joints.push_back(uv::Vec<uint32_t, 4>(first, uint32_t((first + 1) % joints), uint32_t((i * 7) % joints), uint32_t((i / 3) % joints)));
+		const float w0 = std::abs(signed_unit_float()), w1 = std::abs(signed_unit_float()), w2 = i % 2 ? 0.f : std::abs(signed_unit_float());
+		const float sum = w0 + w1 + w2 + 0.1f;
+		weights.weights.push_back(uv::vector(U(w0 / sum), U(w1 / sum), U(w2 / sum), U(i % 5 ? 0.1f / sum : 0.f)));
+		positions.push_back(random_point().v);
+		normals.push_back(uv::vector(U(0.f), U(0.6f), U(-0.8f)));
+	}
+	uv::VecArray<T, 3> moved;
+	uv::VecArray<U, 3> turned;
+	const gsl::span<const DQ> joint_span(pose.data(), pose.size());
+	skin(joint_span, weights, positions, moved, normals, turned);
+	CHECK(moved.size() == vertices);
+	for (size_t i = 0; i < vertices; ++i)
+	{
+		DQ influences[4];
+		U w[4];
+		for (size_t k = 0; k < 4; ++k)
+		{
+			influences[k] = pose[weights.joints.lane(k)[i]];
+			w[k] = weights.weights.lane(k)[i];
+		}
+		const auto c = blend(gsl::span<const DQ>(influences, 4), gsl::span<const U>(w, 4));
+		CHECK_APPROX(moved[i] == (c*uv::point(positions[i])).v);
+		CHECK_APPROX(turned[i] == c*normals[i]);
+	}
+	tester::presicion = tester::default_float_presicion;
+	uv::VecArray<T, 3> in_place = positions;
+	skin(joint_span, weights, in_place, in_place);
+	for (size_t i = 0; i < vertices; ++i)
+		CHECK(in_place[i] == moved[i]);
+}
+
+template <class T>
+void test_lie()
+{
+	using U = uv::type::identity<T>;
+	using M = uv::Mat<U, 3, 3>;
+	const U eps = std::numeric_limits<U>::epsilon();
+	const auto random_vector = [](float scale) { return uv::vector(U(signed_unit_float() * scale), U(signed_unit_float() * scale), U(signed_unit_float() * scale)); };
+	const auto between = [](const uv::Rot3<U>& x, const uv::Rot3<U>& y)
+	{
+		const auto d = conjugate(quaternion(x)) * quaternion(y);
+		return U(2) * std::atan2(length(d.im), std::abs(d.re));
+	};
+	const auto check_near = [](const M& a, const M& b, U tolerance)
+	{
+		for (size_t i = 0; i < 3; ++i)
+			for (size_t j = 0; j < 3; ++j)
+				CHECK(tolerance >= std::abs(rows(a)[i][j] - rows(b)[i][j]));
+	};
+	const M I = M(uv::Vec3<U>(U(1)));
+
+	for (const float scale : { 0.f, 1e-8f, 1e-5f, 1e-3f, 0.02f, 0.5f, 1.f, 1.8f })
+		Repeat(50) << [&]
+		{
+			const auto phi = random_vector(scale);
+			const auto r = exp(phi);
+			CHECK(std::abs(square(quaternion(r)) - U(1)) < U(4)*eps);
+			if (square(phi) > U(0))
+				CHECK(between(r, rotation(phi)) < U(1e-5f));
+			CHECK(length(log(r) - phi) < U(8)*eps*(U(1) + length(phi)));
+		};
+	// near pi, where asin in vector() loses precision, and with either sign of quaternion
+	const auto axis = uv::vector(U(0.48f), U(-0.6f), U(0.64f));
+	for (const U angle : { U(3.14159f), U(3.141592) })
+	{
+		const auto r = exp(axis * angle);
+		CHECK(length(log(r) - axis * angle) < U(8)*eps*angle);
+		CHECK(length(log(uv::Rot3<U>::fromUnchecked(-quaternion(r))) - axis * angle) < U(8)*eps*angle);
+	}
+
+	// the Jacobians against finite differences, which have errors of order d^2 and eps/d
+	const U d = std::is_same_v<U, float> ? U(1e-2f) : U(1e-5);
+	const U tolerance = std::is_same_v<U, float> ? U(2e-3f) : U(1e-8);
+	for (const float scale : { 0.f, 1e-5f, 0.01f, 1.f, 1.5f })
+		Repeat(20) << [&]
+		{
+			const auto phi = random_vector(scale);
+			const M jl = left_jacobian(phi), jr = right_jacobian(phi);
+			M dl, dr;
+			for (size_t k = 0; k < 3; ++k)
+			{
+				auto step = uv::Vec3<U>(U(0));
+				step[k] = d;
+				const auto plus = exp(phi + step), minus = exp(phi - step);
+				const auto l = (log(plus * invert(exp(phi))) - log(minus * invert(exp(phi)))) / (U(2)*d);
+				const auto r = (log(invert(exp(phi)) * plus) - log(invert(exp(phi)) * minus)) / (U(2)*d);
+				for (size_t j = 0; j < 3; ++j)
+				{
+					rows(dl)[j][k] = l[j];
+					rows(dr)[j][k] = r[j];
+				}
+			}
+			check_near(jl, dl, tolerance);
+			check_near(jr, dr, tolerance);
+			check_near(jl * left_jacobian_inverse(phi), I, U(16)*eps);
+			check_near(jr * right_jacobian_inverse(phi), I, U(16)*eps);
+			check_near(jr, left_jacobian(-phi), U(4)*eps);
+		};
+
+	const auto random_point = [] { return uv::Point3<T>(T(signed_unit_float() * 10), T(signed_unit_float() * 10), T(signed_unit_float() * 10)); };
+	for (const float scale : { 0.f, 1e-6f, 1e-3f, 0.5f, 1.5f })
+		Repeat(50) << [&]
+		{
+			const uv::Twist<T> xi = { random_point().v, random_vector(scale) };
+			const auto tf = exp(xi);
+			const auto back = log(tf);
+			CHECK(length(back.phi - xi.phi) < U(8)*eps*(U(1) + length(xi.phi)));
+			CHECK(length(back.rho - xi.rho) < T(U(100)*eps*U(10)));
+			// half the twist twice is the whole motion
+			const auto half = exp(uv::Twist<T>{ xi.rho * U(0.5f), xi.phi * U(0.5f) });
+			const auto p = random_point();
+			CHECK(length((half * half) * p - tf * p) < T(U(200)*eps*U(10)));
+		};
+	// a twist without rotation is a translation, and one without translation a rotation about the origin
+	const uv::Twist<T> slide = { random_point().v, uv::Vec3<U>(U(0)) };
+	CHECK(length(exp(slide).t - slide.rho) < T(U(4)*eps*U(10)));
+	CHECK(between(exp(slide).r, uv::Rot3<U>(uv::identity)) < U(4)*eps);
+	const uv::Twist<T> turn = { uv::Vec3<T>(T(0)), random_vector(1) };
+	CHECK(length(exp(turn).t) < T(U(4)*eps));
+	CHECK(between(exp(turn).r, exp(turn.phi)) < U(4)*eps);
+
+	std::vector<uv::Vec3<U>> phis;
+	std::vector<uv::Twist<T>> xis;
+	for (int i = 0; i < 20; ++i)
+	{
+		phis.push_back(random_vector(i % 2 ? 1.f : 1e-4f));
+		xis.push_back({ random_point().v, phis.back() });
+	}
+	std::vector<uv::Rot3<U>> rs(phis.size(), uv::Rot3<U>(uv::identity));
+	std::vector<uv::Vec3<U>> logs(phis.size());
+	std::vector<uv::Trans3<T>> tfs(xis.size(), uv::Trans3<T>(uv::identity));
+	std::vector<uv::Twist<T>> twist_logs(xis.size());
+	exp(gsl::span<const uv::Vec3<U>>(phis.data(), phis.size()), gsl::span<uv::Rot3<U>>(rs.data(), rs.size()));
+	log(gsl::span<const uv::Rot3<U>>(rs.data(), rs.size()), gsl::span<uv::Vec3<U>>(logs.data(), logs.size()));
+	exp(gsl::span<const uv::Twist<T>>(xis.data(), xis.size()), gsl::span<uv::Trans3<T>>(tfs.data(), tfs.size()));
+	log(gsl::span<const uv::Trans3<T>>(tfs.data(), tfs.size()), gsl::span<uv::Twist<T>>(twist_logs.data(), twist_logs.size()));
+	for (size_t i = 0; i < phis.size(); ++i)
+	{
+		CHECK(quaternion(rs[i]).im == quaternion(exp(phis[i])).im);
+		CHECK(logs[i] == log(rs[i]));
+		CHECK(tfs[i].t == exp(xis[i]).t);
+		CHECK(twist_logs[i].rho == log(tfs[i]).rho);
+		CHECK(twist_logs[i].phi == log(tfs[i]).phi);
+	}
+}
+
+template <class T>
+void test_hierarchy()
+{
+	using U = uv::type::identity<T>;
+	const auto random_transform = []
+	{
+		const auto r = rotation(uv::quaternion(signed_unit_float(), uv::vector(signed_unit_float(), signed_unit_float(), signed_unit_float())));
+		return uv::Trans3<T>(r, uv::vector(T(signed_unit_float()), T(signed_unit_float()), T(signed_unit_float())));
+	};
+	// the paths may round differently, eg. with fused multiply-adds, and errors grow with depth
+	tester::presicion = 1e-5f;
+	const auto check_same = [](const uv::Trans3<T>& a, const uv::Trans3<T>& b)
+	{
+		CHECK(length(a.t - b.t) < T(1e-4f));
+		CHECK_APPROX(quaternion(a.r) == quaternion(b.r));
+	};
+
+	// a forest with wide and deep parts, each node below one added before it
+	uv::TransformHierarchy<T> hierarchy(true);
+	for (uint32_t i = 0; i < 2000; ++i)
+		hierarchy.add(random_transform(), i % 97 == 0 ? hierarchy.none : uint32_t(rng() % i));
+	const auto expected = [&]
+	{
+		std::vector<uv::Trans3<T>> world;
+		for (uint32_t i = 0; i < hierarchy.size(); ++i)
+			world.push_back(hierarchy.parent(i) == hierarchy.none ? hierarchy.local(i) : world[hierarchy.parent(i)] * hierarchy.local(i));
+		return world;
+	};
+	const auto check_matches = [&]
+	{
+		const auto world = expected();
+		CHECK(hierarchy.world().size() == world.size());
+		CHECK(hierarchy.matrices().size() == world.size());
+		for (uint32_t i = 0; i < world.size(); ++i)
+		{
+			check_same(hierarchy.world(i), world[i]);
+			const auto m = homogeneous(world[i]);
+			for (size_t j = 0; j < 4; ++j)
+				CHECK(length(rows(hierarchy.matrices()[i])[j] - rows(m)[j]) < U(1e-4f));
+		}
+	};
+	check_matches();
+	CHECK(hierarchy.update() == 0);
+	for (uint32_t i = 0; i < hierarchy.size(); ++i)
+	{
+		CHECK(hierarchy.depth(i) < hierarchy.levels());
+		if (hierarchy.parent(i) == hierarchy.none)
+			CHECK(hierarchy.depth(i) == 0);
+		else
+			CHECK(hierarchy.depth(i) == hierarchy.depth(hierarchy.parent(i)) + 1);
+	}
+
+	// a few changes recompute exactly the changed nodes and their descendants
+	for (int round = 0; round < 5; ++round)
+	{
+		std::vector<uint8_t> moved(hierarchy.size(), 0);
+		for (int k = 0; k < 3 + round; ++k)
+		{
+			const uint32_t node = uint32_t(rng() % hierarchy.size());
+			hierarchy.set_local(node, random_transform());
+			moved[node] = 1;
+		}
+		size_t count = 0;
+		for (uint32_t i = 0; i < hierarchy.size(); ++i)
+		{
+			moved[i] = moved[i] || (hierarchy.parent(i) != hierarchy.none && moved[hierarchy.parent(i)]);
+			count += moved[i];
+		}
+		CHECK(hierarchy.update() == count);
+		check_matches();
+	}
+
+	// nodes added below a changed node before the update, and setting a node back to its transform
+	const uint32_t root = hierarchy.add(random_transform());
+	hierarchy.set_local(root, random_transform());
+	const uint32_t child = hierarchy.add(random_transform(), root);
+	hierarchy.add(random_transform(), child);
+	CHECK(hierarchy.update() == 3);
+	check_matches();
+	hierarchy.set_local(child, hierarchy.local(child));
+	CHECK(hierarchy.update() == 2);
+	check_matches();
+
+	// a level wide enough to be composed on several threads
+	uv::TransformHierarchy<T> wide;
+	const uint32_t top = wide.add(random_transform());
+	for (size_t i = 0; i < 2*wide.parallel_level; ++i)
+		wide.add(random_transform(), top);
+	for (uint32_t i = 1; i <= 64; ++i)
+		wide.add(random_transform(), i);
+	const auto moved = random_transform();
+	wide.set_local(top, moved);
+	CHECK(wide.update(4) == wide.size());
+	wide.set_local(7, random_transform());
+	CHECK(wide.update(4) == 2);
+	for (uint32_t i = 1; i < wide.size(); ++i)
+		check_same(wide.world(i), wide.world(wide.parent(i)) * wide.local(i));
+}
+
+template <class T>
+void test_sim3()
+{
+	using U = uv::type::identity<T>;
+	// drawn apart from rng, so that the subcases after this one see the same values whatever it draws
+	std::mt19937 engine;
+	const auto unit = [&] { return std::uniform_real_distribution<float>{-1.f, 1.f}(engine); };
+	const auto random_point = [&] { return uv::Point3<T>(T(unit() * 10), T(unit() * 10), T(unit() * 10)); };
+	const auto random_rotation = [&] { return rotation(uv::quaternion(unit(), uv::vector(unit(), unit(), unit()))); };
+	const auto random_sim = [&] { return uv::Sim3<T>(random_rotation(), U(0.1f + 4*std::abs(unit())), random_point().v); };
+	tester::presicion = 1e-5f;
+	Repeat(100) << [&]
+	{
+		const auto a = random_sim(), b = random_sim();
+		const uv::Trans3<T> c(random_rotation(), random_point().v);
+		const auto p = random_point(), q = random_point();
+		CHECK_APPROX(a*p - a*q == a*(p - q));
+		CHECK_APPROX(float(length(a*p - a*q) / T(1)) == float(length(p - q)*a.s / T(1)));
+		CHECK_APPROX(((a*b)*p).v == (a*(b*p)).v);
+		CHECK_APPROX((invert(a)*(a*p)).v == p.v);
+		CHECK_APPROX(((a*invert(a))*p).v == p.v);
+		// rigid motions are similarities of scale one, on either side
+		CHECK_APPROX((uv::Sim3<T>(c)*p).v == (c*p).v);
+		CHECK_APPROX(((a*c)*p).v == (a*(c*p)).v);
+		CHECK_APPROX(((c*a)*p).v == (c*(a*p)).v);
+		const auto m = homogeneous(a);
+		const auto h = m * uv::vector(p.v[0] / T(1), p.v[1] / T(1), p.v[2] / T(1), U(1));
+		CHECK_APPROX(uv::vector(T(h[0]), T(h[1]), T(h[2])) == (a*p).v);
+		CHECK_APPROX(h[3] == U(1));
+	};
+	const auto one = uv::Sim3<T>(uv::identity) * random_point();
+	CHECK(all((uv::Sim3<T>(uv::identity) * one).v == one.v));
+
+	const auto tf = random_sim();
+	std::vector<uv::Point3<T>> points;
+	std::vector<uv::Vec3<T>> vectors;
+	for (int i = 0; i < 37; ++i)
+	{
+		points.push_back(random_point());
+		vectors.push_back(random_point().v);
+	}
+	std::vector<uv::Point3<T>> moved(points.size());
+	std::vector<uv::Vec3<T>> turned(vectors.size());
+	transform(tf, gsl::span<const uv::Point3<T>>(points.data(), points.size()), gsl::span<uv::Point3<T>>(moved.data(), moved.size()));
+	transform(tf, gsl::span<const uv::Vec3<T>>(vectors.data(), vectors.size()), gsl::span<uv::Vec3<T>>(turned.data(), turned.size()));
+	uv::VecArray<T, 3> soa, soa_moved;
+	for (const auto& p : points)
+		soa.push_back(p.v);
+	transform(tf, soa, soa_moved);
+	CHECK(soa_moved.size() == points.size());
+	for (size_t i = 0; i < points.size(); ++i)
+	{
+		CHECK_APPROX(moved[i].v == (tf*points[i]).v);
+		CHECK_APPROX(soa_moved[i] == (tf*points[i]).v);
+		CHECK_APPROX(turned[i] == tf*vectors[i]);
+	}
+	tester::presicion = tester::default_float_presicion;
+}
 
 template <class T>
 void fuzz_vectors()
@@ -309,15 +1738,20 @@ void fuzz_vectors()
 		Subcase("selectors")       << [&] { test_selectors<uv::Vec<T, 4>>(a); };
 		Subcase("const selectors") << [&] { test_selectors<const uv::Vec<T, 4>>(a); };
 		Subcase("arithmetics")     << [&] { test_arithmetics(a, b, c); };
+		Subcase("lazy")            << [&] { test_lazy(a, b, c); };
 		Subcase("dot product")   << [&] { test_dot_product(a, b); };
 		Subcase("cross product") << [&] { test_cross_product(a, b); };
 		Subcase("decomposition") << [&] { test_decomposition(a); };
 		Subcase("components")    << [&] { test_components(a, c); };
 		Subcase("bounds")     << [&] { test_bounds(a, b, c); };
+		Subcase("vector array") << [&] { test_vec_array(a, b, c); };
 		Subcase("matrix")     << [&] { test_matrix(a); };
 		Subcase("complex")    << [&] { test_complex(a); };
 		Subcase("quaternion") << [&] { test_quaternion(a); };
 		Subcase("rotate")     << [&] { test_rotate(a); };
+		Subcase("batch transform") << [&] { test_batch_transform(a, b); };
+		Subcase("simd")       << [&] { test_simd(a, b); };
+		Subcase("eigen")      << [&] { test_eigen(a, b); };
 	};
 }
 
@@ -338,7 +1772,71 @@ TEST_CASE("uvector")
 	Subcase("constants") << []
 	{
 		test_pi();
+		test_anglef();
+	};
+
+	Subcase("bvh") << []
+	{
+		test_bvh<float>();
+		test_bvh<units::Distance<float>>();
+	};
+
+	Subcase("ray") << []
+	{
+		test_ray<float>();
+		test_ray<units::Distance<float>>();
+	};
+
+	Subcase("frustum") << []
+	{
+		test_frustum<float>();
+		test_frustum<units::Distance<float>>();
+	};
+
+	Subcase("reduce") << []
+	{
+		test_reduce<float>();
+		test_reduce<units::Distance<float>>();
+	};
+
+	Subcase("stats") << []
+	{
+		test_stats<float>();
+		test_stats<double>();
+		test_stats<units::Distance<float>>();
+	};
+
+	Subcase("morton") << []
+	{
+		test_morton<float>();
+		test_morton<units::Distance<float>>();
+	};
+
+	Subcase("kdtree") << []
+	{
+		test_kdtree<float>();
+		test_kdtree<units::Distance<float>>();
+	};
+	Subcase("hashgrid") << []
+	{
+		test_hashgrid<float>();
+		test_hashgrid<units::Distance<float>>();
+	};
+	Subcase("aabbtree") << []
+	{
+		test_aabbtree<float>();
+		test_aabbtree<units::Distance<float>>();
+	};
+	Subcase("octree") << []
+	{
+		test_octree<float>();
+		test_octree<units::Distance<float>>();
 	};
+	Subcase("slerp") << test_slerp;
+	Subcase("dualquat") << []{ test_dualquat<float>(); test_dualquat<units::Distance<float>>(); };
+	Subcase("lie") << []{ test_lie<float>(); test_lie<double>(); test_lie<units::Distance<float>>(); };
+	Subcase("hierarchy") << []{ test_hierarchy<float>(); test_hierarchy<units::Distance<float>>(); };
+	Subcase("sim3") << []{ test_sim3<float>(); test_sim3<double>(); test_sim3<units::Distance<float>>(); };
 
 	Subcase("float") << fuzz_vectors<float>;
 	Subcase("Distance") << fuzz_vectors<units::Distance<float>>;